@@ -13,6 +13,8 @@ fn main() -> Result<()> {
     link_cplusplus();
     // Configure and build the CMake project
     run_cmake("core", "laplace-eq-therm-server-core");
+    // Link the system libraries the core depends on
+    link_system_libraries();
     // Generate bindings from core/Lib.hh
     generate_bindings("./core/Public/leth/Lib.hh", "-I./core/Public")
 }
@@ -53,26 +55,68 @@ fn link_cplusplus() {
     println!("cargo:rustc-link-lib=c++");
 }
 
+#[cfg(target_os = "linux")]
+fn link_system_libraries() {
+    // shm_open and shm_unlink are in librt before glibc 2.34
+    println!("cargo:rustc-link-lib=rt");
+}
+
+#[cfg(not(target_os = "linux"))]
+fn link_system_libraries() {
+    /* do nothing */
+}
+
 fn run_cmake(source_dir: &str, target_name: &str) {
     let sources = [
         // Header files
+        "BoundaryInfluenceSpace.hh",
+        "CholeskySpace.hh",
+        "Config.hh",
+        "FastPoissonSpace.hh",
+        "Fft.hh",
         "FiniteElementMethodSpace.hh",
         "IntegerTypes.hh",
+        "Journal.hh",
         "Lib.hh",
         "MatrixSpace.hh",
         "MonteCarloSpace.hh",
         "Point.hh",
+        "ResultEncoding.hh",
+        "ResultFrame.hh",
         "Server.hh",
+        "SharedResults.hh",
+        "SineTransform.hh",
         "Space.hh",
+        "SparseCholesky.hh",
+        "SparseMatrix.hh",
+        "SpaceRegistry.hh",
+        "SpaceStats.hh",
         "SuccessiveOverRelaxationSpace.hh",
+        "ThreadPolicy.hh",
+        "WorkerPool.hh",
+        "Xoshiro256.hh",
 
         // Source files
+        "BoundaryInfluenceSpace.cc",
+        "CholeskySpace.cc",
         "Config.cc",
+        "FastPoissonSpace.cc",
+        "Fft.cc",
         "FiniteElementMethodSpace.cc",
+        "Journal.cc",
         "MatrixSpace.cc",
         "MonteCarloSpace.cc",
+        "ResultEncoding.cc",
+        "ResultFrame.cc",
         "Server.cc",
+        "SharedResultPublisher.cc",
+        "SharedResultReader.cc",
+        "SineTransform.cc",
+        "SparseCholesky.cc",
+        "SpaceRegistry.cc",
         "SuccessiveOverRelaxationSpace.cc",
+        "ThreadPolicy.cc",
+        "WorkerPool.cc",
 
         // CMake
         "CMakeLists.txt",
@@ -0,0 +1,89 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_BOUNDARY_INFLUENCE_SPACE_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_BOUNDARY_INFLUENCE_SPACE_HH
+
+#include <leth/MatrixSpace.hh>
+#include <leth/SparseCholesky.hh>
+#include <leth/WorkerPool.hh>
+
+#include <cstdint>
+#include <vector>
+
+/// Solves the equation by superposing precomputed responses. The solution is linear in the
+/// right-hand side, which only has nonzeros next to boundary points, so for each topology this
+/// space computes the response of the whole field to a unit change next to every boundary point,
+/// i.e. the columns of A⁻¹ of those unknowns. A temperature update then costs one scaled vector
+/// add per changed unknown instead of a solve.
+///
+/// Responses are stored in tiles of consecutive unknowns. Tiles whose values are negligible are
+/// skipped, and with `SpaceFlag::CompressInfluence` the others are quantized to 16 bits with a
+/// scale per tile. The error these introduce is bounded per update; once the accumulated bound
+/// exceeds the tolerance, the field is solved again from the factorization.
+///
+/// Responses are only precomputed while they take at most 2^26 values, i.e. 256 MiB as floats or
+/// 128 MiB compressed. Larger topologies solve every update from the factorization, like
+/// `CholeskySpace`.
+class BoundaryInfluenceSpace : public MatrixSpace
+{
+  private:
+    /// Scratch buffers of a worker computing responses
+    struct WorkerScratch
+    {
+        std::vector<float>  rhs;
+        std::vector<float>  response;
+        std::vector<double> work;
+    };
+
+  private:
+    bool       _compressed;
+    float      _tolerance;
+    WorkerPool _workers;
+
+    // Per topology
+    bool                   _built;
+    bool                   _valid;
+    std::vector<PointType> _influencePointTypes;
+    SparseCholesky         _factorization;
+    std::vector<uint32_t>  _order;
+    std::vector<uint32_t>  _columns;
+    std::vector<int32_t>   _i2Column;
+    size_t                 _numTiles;
+    std::vector<float>     _tileScales;
+    std::vector<float>     _columnErrors;
+    std::vector<float>     _values;
+    std::vector<int16_t>   _quantizedValues;
+
+    // Per update
+    std::vector<float>         _lastB;
+    float                      _errorBound;
+    bool                       _solved;
+    std::vector<uint32_t>      _changed;
+    std::vector<double>        _work;
+    std::vector<WorkerScratch> _scratches;
+
+  public:
+    BoundaryInfluenceSpace(uint16_t width, uint16_t height, SpaceConfig const& config = {});
+
+  protected:
+    virtual char const* GetName() noexcept override final;
+
+    virtual void SetThreadPolicy(ThreadPolicy const& policy) noexcept override final;
+
+    virtual bool SolveEquation(SparseMatrix const&       A,
+                               std::vector<float>&       x,
+                               std::vector<float> const& b) noexcept override final;
+
+  private:
+    /// Factorizes `A` and computes the responses of the current topology.
+    void BuildInfluence(SparseMatrix const& A);
+
+    /// Stores the response to the unknown of the given column.
+    void StoreColumn(size_t column, std::vector<float> const& response) noexcept;
+
+    /// Adds the response to the unknown of the given column times `delta` to `x`.
+    void AddColumn(size_t column, float delta, float* x) const noexcept;
+};
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_CHOLESKY_SPACE_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_CHOLESKY_SPACE_HH
+
+#include <leth/MatrixSpace.hh>
+#include <leth/SparseCholesky.hh>
+
+#include <cstdint>
+#include <vector>
+
+/// Solves the equation directly with a sparse LDLᵀ factorization. The unknowns are ordered by
+/// nested dissection of the grid to limit the fill-in. Factorizations are cached per topology, so
+/// a temperature update costs two triangular solves.
+class CholeskySpace : public MatrixSpace
+{
+  private:
+    struct CachedFactorization
+    {
+        uint64_t               topologyHash;
+        std::vector<PointType> pointTypes;
+        bool                   valid;
+        SparseCholesky         factorization;
+    };
+
+  private:
+    std::vector<CachedFactorization> _factorizations;
+    std::vector<uint32_t>            _order;
+    std::vector<double>              _work;
+
+  public:
+    CholeskySpace(uint16_t width, uint16_t height, SpaceConfig const& config = {});
+
+  protected:
+    virtual char const* GetName() noexcept override final;
+
+    virtual bool SolveEquation(SparseMatrix const&       A,
+                               std::vector<float>&       x,
+                               std::vector<float> const& b) noexcept override final;
+
+  private:
+    /// Returns the factorization of the current topology, factorizing `A` if it is not cached.
+    CachedFactorization* GetFactorization(SparseMatrix const& A);
+};
+
+#endif
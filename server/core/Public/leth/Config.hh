@@ -0,0 +1,88 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_CONFIG_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_CONFIG_HH
+
+#include <cstdint>
+
+/// Represents the optional behaviors of a space. Flags are combined as bit flags.
+enum class SpaceFlag : uint32_t
+{
+    None = 0,
+    /// Stores the precomputed responses of `BoundaryInfluenceSpace` quantized to 16 bits, halving
+    /// their memory at the cost of more frequent full solves.
+    CompressInfluence = 1,
+};
+
+/// Represents the parameters of a space. Fields left zero fall back to the defaults of the space,
+/// so a zero-initialized configuration with only `name` set is valid.
+struct SpaceConfig
+{
+    /// Name of the space in the registry, e.g. "SuccessiveOverRelaxationSpace"
+    char const* name;
+    /// Number of threads a single simulation may use (default: 1)
+    uint32_t numThreads;
+    /// Maximum number of sweeps of iterative solvers
+    uint32_t maxIterations;
+    /// Tolerance whose meaning depends on the space:
+    ///
+    /// * `SuccessiveOverRelaxationSpace`: the largest change of a point within a sweep at which
+    ///   the solver stops (default: 0.001)
+    /// * `BoundaryInfluenceSpace`: the bound of the error incremental updates may accumulate
+    ///   before the field is solved again (default: 0.001)
+    /// * `MonteCarloSpace`: the standard error at which every point stops receiving more random
+    ///   walks (default: none, the whole walk budget is spent)
+    float tolerance;
+    /// Relaxation factor of `SuccessiveOverRelaxationSpace`. Zero tunes the factor per geometry.
+    float omega;
+    /// Average number of random walks per point of `MonteCarloSpace`
+    uint32_t numWalks;
+    /// Time budget of a single simulation of `MonteCarloSpace` in milliseconds (default: none)
+    uint32_t timeBudgetMs;
+    /// Combination of `SpaceFlag`s
+    uint32_t flags;
+    /// Factor of 2, 4 or 8 by which `SuccessiveOverRelaxationSpace` coarsens the grid after a
+    /// topology change, to publish a preview and start from it (default: no preview)
+    uint32_t previewScale;
+};
+
+/// Represents the optional behaviors of a server. Flags are combined as bit flags.
+enum class ServerFlag : uint32_t
+{
+    None = 0,
+    /// Schedules the space threads and their workers as CPU-bound batch jobs (`SCHED_BATCH` on
+    /// Linux), so that they do not preempt request handlers when they wake up.
+    BatchScheduling = 1,
+    /// Puts a space thread to sleep once its result for the current input has converged, until
+    /// the input changes. Otherwise spaces simulate the same input again and again.
+    IdleWhenConverged = 2,
+};
+
+/// Represents the configuration of a server. Fields after `numSpaces` left zero fall back to the
+/// defaults.
+struct ServerConfig
+{
+    /// Width of the matrix
+    uint16_t width;
+    /// Height of the matrix
+    uint16_t height;
+    /// Spaces to run, in the order of their indices
+    SpaceConfig const* spaces;
+    /// Number of elements of `spaces`
+    uint32_t numSpaces;
+    /// Combination of `ServerFlag`s
+    uint32_t flags;
+    /// Cores the space threads and their workers run on, bit n for core n (default: any core)
+    uint64_t solverCpuMask;
+    /// Nice value of the space threads and their workers, e.g. 10 to leave the cores to request
+    /// handlers first
+    int32_t solverNice;
+    /// Cores the thread applying point updates runs on. A core outside `solverCpuMask` keeps
+    /// updates flowing while the solvers are busy. (default: any core)
+    uint64_t ingestionCpuMask;
+    /// Nice value of the thread applying point updates. Negative values need privileges.
+    int32_t ingestionNice;
+};
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_FAST_POISSON_SPACE_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_FAST_POISSON_SPACE_HH
+
+#include <leth/MatrixSpace.hh>
+#include <leth/SineTransform.hh>
+#include <leth/SparseCholesky.hh>
+
+#include <cstdint>
+#include <vector>
+
+/// Solves rectangular domains directly with the discrete sine transform. The five-point Laplacian
+/// of a rectangle surrounded by boundary points is the sum of second differences along the rows
+/// and along the columns, and the sine transform of the rows diagonalizes the former. This leaves
+/// one tridiagonal system per sine mode along the columns, so a solve costs two transforms of the
+/// rows and O(N) work in between.
+///
+/// Other domains are solved with a sparse LDLᵀ factorization of the current topology.
+class FastPoissonSpace : public MatrixSpace
+{
+  private:
+    // Per topology
+    bool                   _prepared;
+    std::vector<PointType> _preparedPointTypes;
+    bool                   _rectangular;
+    uint32_t               _numColumns, _numRows;
+    std::vector<uint32_t>  _grid2I;
+    std::vector<double>    _pivots;
+    SineTransform          _sineTransform;
+    bool                   _factorized;
+    SparseCholesky         _factorization;
+    std::vector<uint32_t>  _order;
+
+    // Per solve
+    std::vector<double> _grid;
+    std::vector<double> _work;
+
+  public:
+    FastPoissonSpace(uint16_t width, uint16_t height, SpaceConfig const& config = {});
+
+  protected:
+    virtual char const* GetName() noexcept override final;
+
+    virtual bool SolveEquation(SparseMatrix const&       A,
+                               std::vector<float>&       x,
+                               std::vector<float> const& b) noexcept override final;
+
+  private:
+    /// Prepares the transform of a rectangle or factorizes `A` otherwise.
+    void Prepare(SparseMatrix const& A);
+
+    /// Solves the equation of a rectangle.
+    void SolveRectangle(std::vector<float>& x, std::vector<float> const& b) noexcept;
+};
+
+#endif
@@ -0,0 +1,64 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_FFT_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_FFT_HH
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// `Fft` computes the discrete Fourier transform of a fixed length. Lengths whose prime factors
+/// are small are split recursively by mixed-radix Cooley-Tukey steps; other lengths are turned
+/// into a convolution of a power-of-two length with Bluestein's algorithm. Either way the cost is
+/// O(n log n).
+class Fft
+{
+  public:
+    using Complex = std::complex<double>;
+
+  private:
+    /// A Cooley-Tukey step splitting a transform of `radix` * `length` points
+    struct Stage
+    {
+        uint32_t radix;
+        size_t   length;
+    };
+
+  private:
+    size_t               _length;
+    std::vector<Stage>   _stages;
+    std::vector<Complex> _twiddles;
+    std::vector<Complex> _buffer;
+
+    // Bluestein's algorithm
+    std::unique_ptr<Fft> _convolution;
+    std::vector<Complex> _chirp;
+    std::vector<Complex> _filter;
+
+  public:
+    explicit Fft(size_t length = 0);
+
+  public:
+    /// Returns the number of points of the transform
+    size_t length() const noexcept
+    {
+        return _length;
+    }
+
+    /// Replaces `data` of `length()` points with its transform, X_k = Σ x_j exp(-2πi jk / n).
+    void Transform(Complex* data) noexcept;
+
+  private:
+    /// Transforms the points `in`, `in + stride`, ... into `out` from the given stage on.
+    void Work(Complex* out, Complex const* in, size_t stride, size_t stage) noexcept;
+
+    /// Combines the `radix` transforms of `length` points in `out` into one.
+    void Butterfly(Complex* out, size_t stride, uint32_t radix, size_t length) noexcept;
+
+    void TransformBluestein(Complex* data) noexcept;
+};
+
+#endif
@@ -4,12 +4,13 @@
 #ifndef LAPLACE_EQ_THERM_SERVER_CORE_FINITE_ELEMENT_METHOD_SPACE_HH
 #define LAPLACE_EQ_THERM_SERVER_CORE_FINITE_ELEMENT_METHOD_SPACE_HH
 
+#include <leth/Config.hh>
 #include <leth/Space.hh>
 
 class FiniteElementMethodSpace : public Space
 {
   public:
-    FiniteElementMethodSpace(uint16_t width, uint16_t height);
+    FiniteElementMethodSpace(uint16_t width, uint16_t height, SpaceConfig const& config = {});
 
   protected:
     virtual char const* GetName() noexcept override;
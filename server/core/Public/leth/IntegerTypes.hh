@@ -9,4 +9,9 @@
 using SpaceIndex = uint32_t;
 using ErrorCode  = uint32_t;
 
+/// Returned by the server if the space index is invalid.
+constexpr ErrorCode InvalidSpaceIndexError { static_cast<ErrorCode>(-1) };
+/// Returned by `leth_solve_batch` if the space does not support batches.
+constexpr ErrorCode BatchNotSupportedError { static_cast<ErrorCode>(-2) };
+
 #endif
\ No newline at end of file
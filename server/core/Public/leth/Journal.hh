@@ -0,0 +1,226 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_JOURNAL_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_JOURNAL_HH
+
+#include <leth/IntegerTypes.hh>
+#include <leth/Point.hh>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Represents the type of a record in a journal file.
+enum class JournalRecordType : uint8_t
+{
+    /// A point update applied to the input buffer.
+    SetPoint = 0,
+    /// A snapshot of the simulation result of a space.
+    Checkpoint = 1,
+    /// Marks that some records were not recorded because the writer fell behind or a file could
+    /// not be written.
+    Dropped = 2,
+};
+
+/// Represents a decoded journal record.
+struct JournalRecord
+{
+    JournalRecordType type;
+
+    /// Nanoseconds elapsed since the journal was started
+    int64_t time;
+
+    // SetPoint
+    uint16_t  x, y;
+    float     temp;
+    PointType pointType;
+
+    // Checkpoint
+    SpaceIndex         spaceIdx;
+    ErrorCode          errorCode;
+    std::vector<float> result;
+
+    // Dropped
+    uint64_t numDropped;
+};
+
+/// `Journal` records the point updates applied to a `Server` and periodic checkpoints of the
+/// simulation results into append-only binary files. Records are encoded and written by a
+/// background thread; the callers only pay for a ring buffer append.
+///
+/// Each file starts with a header and is followed by blocks of records. Timestamps and
+/// coordinates are delta-encoded, temperatures are XOR-ed against the previous value of the same
+/// point (or the same cell of the previous checkpoint) and all integers are stored as varints, so
+/// an unchanged value costs a single byte and unchanged runs of a checkpoint collapse into one
+/// varint. Files are rotated when they exceed the given size; every file can be decoded alone.
+/// Records that cannot be written, e.g. because the next file cannot be created, are counted and
+/// reported by a `Dropped` record once a file can be written again.
+class Journal
+{
+  private:
+    struct SetPointEntry
+    {
+        int64_t   time;
+        uint16_t  x, y;
+        float     temp;
+        PointType type;
+    };
+
+    struct CheckpointSlot
+    {
+        std::mutex           lock;
+        bool                 pending { false };
+        int64_t              time { 0 };
+        ErrorCode            errorCode { 0 };
+        std::vector<float>   temp;
+        std::atomic<int64_t> lastTime { 0 };
+    };
+
+    struct EncoderState
+    {
+        int64_t                         time;
+        uint16_t                        x, y;
+        std::vector<uint32_t>           temp;
+        std::vector<std::vector<float>> checkpoints;
+    };
+
+    static constexpr size_t RingCapacity { 1 << 13 };
+
+  private:
+    uint16_t   _width, _height;
+    SpaceIndex _numSpaces;
+
+    std::mutex       _controlLock;
+    std::atomic_bool _active;
+    std::thread      _writerThread;
+
+    std::mutex              _wakeLock;
+    std::condition_variable _wake;
+
+    std::vector<SetPointEntry> _ring;
+    std::atomic<size_t>        _ringHead, _ringTail;
+    std::atomic<uint64_t>      _numDropped, _numDroppedTotal;
+
+    std::vector<CheckpointSlot> _checkpointSlots;
+    int64_t                     _checkpointInterval;
+
+    std::chrono::steady_clock::time_point _startTime;
+    std::string                           _path;
+    uint64_t                              _maxFileSize;
+    uint32_t                              _fileIndex;
+    std::FILE*                            _file;
+    uint64_t                              _fileSize;
+    EncoderState                          _encoder;
+
+  public:
+    Journal(uint16_t width, uint16_t height, SpaceIndex numSpaces);
+    Journal(Journal const&) = delete;
+    Journal& operator=(Journal const&) = delete;
+    ~Journal() noexcept;
+
+  public:
+    /// Starts writing to `<path>.<index>`, switching to the next index whenever the current file
+    /// exceeds `maxFileSize` bytes (0 disables rotation). Results are checkpointed at most once
+    /// every `checkpointIntervalMs` milliseconds per space (0 disables checkpoints).
+    bool Start(char const* path, uint64_t maxFileSize, uint32_t checkpointIntervalMs) noexcept;
+
+    /// Flushes the pending records and closes the current file.
+    void Stop() noexcept;
+
+    /// Returns whether the journal is being written.
+    bool IsActive() const noexcept
+    {
+        return _active.load(std::memory_order_acquire);
+    }
+
+    /// Returns the number of records dropped since the journal was started.
+    uint64_t numDropped() const noexcept
+    {
+        return _numDroppedTotal.load(std::memory_order_relaxed);
+    }
+
+    /// Records an applied point update. Must be called from a single thread at a time.
+    void RecordSetPoint(uint16_t x, uint16_t y, float temp, PointType type) noexcept;
+
+    /// Records the simulation result of the given space if its checkpoint interval has elapsed.
+    void RecordCheckpoint(SpaceIndex spaceIdx, ErrorCode errorCode, float const* temp) noexcept;
+
+  private:
+    int64_t Now() const noexcept;
+    void    WriteRecords() noexcept;
+    bool    OpenNextFile() noexcept;
+    void    CloseFile() noexcept;
+    void    EncodeSetPoint(std::vector<uint8_t>& out, SetPointEntry const& entry);
+    void    EncodeCheckpoint(std::vector<uint8_t>&     out,
+                             SpaceIndex                spaceIdx,
+                             int64_t                   time,
+                             ErrorCode                 errorCode,
+                             std::vector<float> const& temp);
+    void    EncodeDropped(std::vector<uint8_t>& out, int64_t time, uint64_t numDropped);
+};
+
+/// `JournalReader` decodes the files written by `Journal`.
+class JournalReader
+{
+  private:
+    std::FILE*                      _file;
+    uint16_t                        _width, _height;
+    SpaceIndex                      _numSpaces;
+    int64_t                         _startTime;
+    std::vector<uint8_t>            _block;
+    size_t                          _blockOffset;
+    uint32_t                        _blockRecordsLeft;
+    int64_t                         _time;
+    uint16_t                        _x, _y;
+    std::vector<uint32_t>           _temp;
+    std::vector<std::vector<float>> _checkpoints;
+
+  public:
+    JournalReader();
+    JournalReader(JournalReader const&) = delete;
+    JournalReader& operator=(JournalReader const&) = delete;
+    ~JournalReader() noexcept;
+
+  public:
+    /// Opens a single journal file. Returns `false` if the file is not a valid journal.
+    bool Open(char const* path) noexcept;
+
+    /// Decodes the next record. Returns `false` at the end of the file or on a corrupted block.
+    bool Next(JournalRecord& record) noexcept;
+
+    /// Returns the width of the recorded matrix
+    uint16_t width() const noexcept
+    {
+        return _width;
+    }
+
+    /// Returns the height of the recorded matrix
+    uint16_t height() const noexcept
+    {
+        return _height;
+    }
+
+    /// Returns the number of spaces of the recorded server
+    SpaceIndex numSpaces() const noexcept
+    {
+        return _numSpaces;
+    }
+
+    /// Returns the wall-clock time the journal was started at, in nanoseconds since the epoch
+    int64_t startTime() const noexcept
+    {
+        return _startTime;
+    }
+
+  private:
+    bool ReadBlock() noexcept;
+};
+
+#endif
@@ -4,12 +4,17 @@
 #ifndef LAPLACE_EQ_THERM_SERVER_CORE_LIB_HH
 #define LAPLACE_EQ_THERM_SERVER_CORE_LIB_HH
 
+#include <leth/Config.hh>
 #include <leth/IntegerTypes.hh>
 #include <leth/Point.hh>
+#include <leth/ResultEncoding.hh>
+#include <leth/SpaceStats.hh>
 
+#include <cstddef>
 #include <cstdint>
 
 using ServerHandle = void*;
+using ResultHandle = void const*;
 
 extern "C"
 {
@@ -21,6 +26,16 @@ extern "C"
     /// * `height`: height of the matrix
     ServerHandle leth_create(uint16_t width, uint16_t height) noexcept;
 
+    /// Creates a server instance running only the given spaces with the given parameters.
+    /// Registered spaces are `MonteCarloSpace`, `SuccessiveOverRelaxationSpace`,
+    /// `FiniteElementMethodSpace`, `CholeskySpace`, `BoundaryInfluenceSpace` and
+    /// `FastPoissonSpace`. Returns null if a space name is unknown.
+    ///
+    /// # Arguments
+    ///
+    /// * `config`: the configuration of the server
+    ServerHandle leth_create_ex(ServerConfig const* config) noexcept;
+
     /// Returns the number of spaces (algorithm implementers)
     ///
     /// # Arguments
@@ -68,6 +83,31 @@ extern "C"
     ///           `width` * `height` bytes.
     void leth_get(ServerHandle server, float* temp, PointType* type) noexcept;
 
+    /// Gets the current temperature information of all points and the latest simulation result of
+    /// every space in a single call. Returns the generation of the input. The results are taken
+    /// first, so their generations never exceed the returned one; the input and a result with equal
+    /// generations are exactly comparable.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `temp`: the buffer to store temperature. Must be pointing a buffer with size of at least
+    ///           `width` * `height` * 4 bytes.
+    /// * `type`: the buffer to store point types. Must be pointing a buffer with size of at least
+    ///           `width` * `height` bytes.
+    /// * `results`: the buffer to store the results one after another. Must be pointing a buffer
+    ///              with size of at least `numSpaces` * `width` * `height` * 4 bytes.
+    /// * `errorCodes`: the buffer to store the error code of each space. Must be pointing a buffer
+    ///                 with size of at least `numSpaces` * 4 bytes.
+    /// * `generations`: the buffer to store the input generation of each result. Must be pointing
+    ///                  a buffer with size of at least `numSpaces` * 8 bytes.
+    uint64_t leth_get_snapshot(ServerHandle server,
+                               float*       temp,
+                               PointType*   type,
+                               float*       results,
+                               ErrorCode*   errorCodes,
+                               uint64_t*    generations) noexcept;
+
     /// Gets the simulation result.
     ///
     /// # Arguments
@@ -78,6 +118,212 @@ extern "C"
     ///           `width` * `height` * 4 bytes.
     ErrorCode leth_get_res(ServerHandle server, SpaceIndex spaceIdx, float* temp) noexcept;
 
+    /// Returns the number of point updates applied to the input so far. Every simulation result
+    /// is tagged with the value this function returned when its input was taken.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    uint64_t leth_get_generation(ServerHandle server) noexcept;
+
+    /// Gets the simulation result and the generation of the input it was computed from.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `spaceIdx`: the index of the space
+    /// * `temp`: the buffer to store the result. Must be pointing a buffer with size of at least
+    ///           `width` * `height` * 4 bytes.
+    /// * `generation`: the variable to store the generation of the input
+    ErrorCode leth_get_res_with_generation(ServerHandle server,
+                                           SpaceIndex   spaceIdx,
+                                           float*       temp,
+                                           uint64_t*    generation) noexcept;
+
+    /// Acquires the latest simulation result without copying it. The result stays valid and
+    /// unchanged until it is released by `leth_release_res`, which must happen before the server is
+    /// destroyed. Returns null if the space index is invalid.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `spaceIdx`: the index of the space
+    /// * `temp`: the variable to store the pointer to `width` * `height` temperature values
+    /// * `errorCode`: the variable to store the error code of the simulation. May be null.
+    /// * `generation`: the variable to store the generation of the input. May be null.
+    ResultHandle leth_acquire_res(ServerHandle  server,
+                                  SpaceIndex    spaceIdx,
+                                  float const** temp,
+                                  ErrorCode*    errorCode,
+                                  uint64_t*     generation) noexcept;
+
+    /// Releases a result acquired by `leth_acquire_res`.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `result`: the result returned by `leth_acquire_res`
+    void leth_release_res(ServerHandle server, ResultHandle result) noexcept;
+
+    /// Gets the statistics of the simulation that produced the latest result, e.g. the number of
+    /// sweeps and the relaxation factor of iterative solvers. Returns the error code of the result.
+    /// A result with a nonzero `resolutionLevel` is a preview, to be followed by a finer result
+    /// of the same generation.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `spaceIdx`: the index of the space
+    /// * `stats`: the variable to store the statistics
+    ErrorCode leth_get_res_stats(ServerHandle server,
+                                 SpaceIndex   spaceIdx,
+                                 SpaceStats*  stats) noexcept;
+
+    /// Gets the estimated standard error of every point of the latest result, e.g. of the sample
+    /// mean of `MonteCarloSpace`. Returns `false` if the space index is invalid or the space does
+    /// not estimate errors.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `spaceIdx`: the index of the space
+    /// * `error`: the buffer to store `width` * `height` standard errors
+    bool leth_get_res_error(ServerHandle server, SpaceIndex spaceIdx, float* error) noexcept;
+
+    /// Solves several scenarios sharing the point types with the given space and waits for the
+    /// results, independently of the input of the server. Matrix spaces assemble and factorize the
+    /// equation once and solve the scenarios in blocks on the given number of threads. Returns -1
+    /// if the space index is invalid and -2 if the space does not support batches.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `spaceIdx`: the index of the space
+    /// * `type`: the point types. Must be pointing a buffer with size of at least `width` *
+    ///           `height` bytes.
+    /// * `temps`: the temperatures of each scenario, one after another. Only boundary points are
+    ///            read. Must be pointing a buffer with size of at least `numScenarios` * `width` *
+    ///            `height` * 4 bytes.
+    /// * `numScenarios`: the number of scenarios
+    /// * `results`: the buffer to store the result of each scenario, one after another. Must be
+    ///              pointing a buffer with size of at least `numScenarios` * `width` * `height` *
+    ///              4 bytes.
+    /// * `numThreads`: the number of threads to solve with. 0 uses every core.
+    ErrorCode leth_solve_batch(ServerHandle     server,
+                               SpaceIndex       spaceIdx,
+                               PointType const* type,
+                               float const*     temps,
+                               uint32_t         numScenarios,
+                               float*           results,
+                               uint32_t         numThreads) noexcept;
+
+    /// Returns the maximum size in bytes of a result encoded by `leth_get_res_encoded`.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    size_t leth_get_res_encoded_bound(ServerHandle server) noexcept;
+
+    /// Gets the simulation result quantized to 16 bits with a per-frame scale and offset. If the
+    /// buffer is too small, `encodedSize` is set to 0.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `spaceIdx`: the index of the space
+    /// * `flags`: a combination of `ResultEncodingFlag`s
+    /// * `reference`: a frame previously returned without `ResultEncodingFlag::Delta`. Used only
+    ///                with `ResultEncodingFlag::Delta`; may be null.
+    /// * `referenceSize`: the size of `reference` in bytes
+    /// * `buffer`: the buffer to store the encoded result. Should be at least
+    ///             `leth_get_res_encoded_bound` bytes long.
+    /// * `bufferSize`: the size of `buffer` in bytes
+    /// * `encodedSize`: the variable to store the size of the encoded result
+    /// * `maxError`: the variable to store the maximum absolute quantization error
+    ErrorCode leth_get_res_encoded(ServerHandle   server,
+                                   SpaceIndex     spaceIdx,
+                                   uint32_t       flags,
+                                   uint8_t const* reference,
+                                   size_t         referenceSize,
+                                   uint8_t*       buffer,
+                                   size_t         bufferSize,
+                                   size_t*        encodedSize,
+                                   float*         maxError) noexcept;
+
+    /// Decodes a result returned by `leth_get_res_encoded`. Returns `false` if the result is
+    /// malformed or its reference is missing.
+    ///
+    /// # Arguments
+    ///
+    /// * `encoded`: the encoded result
+    /// * `encodedSize`: the size of `encoded` in bytes
+    /// * `reference`: the reference `encoded` was requested with. May be null.
+    /// * `referenceSize`: the size of `reference` in bytes
+    /// * `temp`: the buffer to store the decoded result. Must be pointing a buffer with size of at
+    ///           least `length` * 4 bytes.
+    /// * `length`: the number of values, i.e. `width` * `height`
+    bool leth_decode_res(uint8_t const* encoded,
+                         size_t         encodedSize,
+                         uint8_t const* reference,
+                         size_t         referenceSize,
+                         float*         temp,
+                         size_t         length) noexcept;
+
+    /// Starts recording the applied point updates and periodic checkpoints of the simulation
+    /// results. Returns `false` if the journal is already running or the file cannot be created.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `path`: the path of the journal. Files are named `<path>.0`, `<path>.1`, ...
+    /// * `maxFileSize`: the size in bytes after which the next file is started. 0 disables
+    ///                  rotation.
+    /// * `checkpointIntervalMs`: the minimum interval between two checkpoints of a space in
+    ///                           milliseconds. 0 disables checkpoints.
+    bool leth_start_journal(ServerHandle server,
+                            char const*  path,
+                            uint64_t     maxFileSize,
+                            uint32_t     checkpointIntervalMs) noexcept;
+
+    /// Flushes and closes the journal started by `leth_start_journal`.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    void leth_stop_journal(ServerHandle server) noexcept;
+
+    /// Returns the number of records the journal dropped since it was started, because its
+    /// writer fell behind or a file could not be written.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    uint64_t leth_get_journal_dropped(ServerHandle server) noexcept;
+
+    /// Starts publishing the input and the results of every space into a POSIX shared memory
+    /// object, which other processes read with `SharedResultReader` without copying. Every
+    /// channel is a ring of versioned frames; readers never block the server. Returns `false` if
+    /// the results are already published, the object cannot be created or the platform has no
+    /// POSIX shared memory.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    /// * `name`: the name of the shared memory object, e.g. "/leth". An existing object of the
+    ///           same name is unlinked; readers that mapped it keep it until they reopen the name.
+    /// * `numSlots`: the number of frames of each ring. 0 uses the default of 4.
+    bool leth_start_shared_results(ServerHandle server,
+                                   char const*  name,
+                                   uint32_t     numSlots) noexcept;
+
+    /// Stops publishing and removes the shared memory object created by
+    /// `leth_start_shared_results`.
+    ///
+    /// # Arguments
+    ///
+    /// * `server`: the server instance returned by `leth_create`
+    void leth_stop_shared_results(ServerHandle server) noexcept;
+
     /// Destroys the given server instance.
     ///
     /// # Arguments
@@ -4,11 +4,18 @@
 #ifndef LAPLACE_EQ_THERM_SERVER_CORE_MATRIX_SPACE_HH
 #define LAPLACE_EQ_THERM_SERVER_CORE_MATRIX_SPACE_HH
 
+#include <leth/Config.hh>
 #include <leth/Space.hh>
+#include <leth/SparseMatrix.hh>
 
-#include <random>
 #include <vector>
 
+/// Solves the five-point discretization of the Laplace equation as a linear system. The matrix is
+/// assembled only when the point types change; temperature updates rebuild the right-hand side
+/// and solve again starting from the previous solution.
+///
+/// Batches are solved with one sparse LDLᵀ factorization of their matrix, whatever the space uses
+/// for its simulation, since the factorization pays off over many right-hand sides.
 class MatrixSpace : public Space
 {
   private:
@@ -16,16 +23,29 @@ class MatrixSpace : public Space
     {
         Success,
         InvalidEquation,
+        OutOfMemory,
+    };
+
+  protected:
+    /// A boundary point adjacent to an unknown, contributing its temperature to the right-hand side
+    struct BoundaryTerm
+    {
+        uint32_t i;
+        uint32_t inputIdx;
     };
 
   private:
-    std::vector<float>    _A, _x, _b;
-    std::vector<Pos>      _i2Pos;
-    std::vector<uint32_t> _i2NumNeighboringWalls;
-    std::vector<size_t>   _pos2I;
+    SparseMatrix              _A;
+    std::vector<float>        _x, _b;
+    std::vector<Pos>          _i2Pos;
+    std::vector<size_t>       _pos2I;
+    std::vector<BoundaryTerm> _boundaryTerms;
+    std::vector<PointType>    _pointTypes;
+    uint64_t                  _topologyHash;
+    uint32_t                  _numColumns, _numRows;
 
   public:
-    MatrixSpace(uint16_t width, uint16_t height);
+    MatrixSpace(uint16_t width, uint16_t height, SpaceConfig const& config = {});
 
   protected:
     virtual char const* GetName() noexcept override;
@@ -34,17 +54,91 @@ class MatrixSpace : public Space
 
     virtual ErrorCode RunSimulation(Point const* input, float* output) noexcept override final;
 
-    /// Solves the equation Ax = b.
-    virtual void SolveEquation(std::vector<float> const& A,
+    virtual ErrorCode SolveBatch(PointType const*    type,
+                                 float const*        temps,
+                                 size_t              numScenarios,
+                                 float*              results,
+                                 uint32_t            numThreads,
+                                 ThreadPolicy const& policy) noexcept override final;
+
+    /// Returns the topology hash of the input of the current equation. Different topologies may
+    /// share a hash, so a cache keyed by it must compare `pointTypes` on a hit.
+    uint64_t topologyHash() const noexcept
+    {
+        return _topologyHash;
+    }
+
+    /// Returns the point types of the input of the current equation.
+    std::vector<PointType> const& pointTypes() const noexcept
+    {
+        return _pointTypes;
+    }
+
+    /// Returns the positions of the unknowns of the current equation.
+    std::vector<Pos> const& positions() const noexcept
+    {
+        return _i2Pos;
+    }
+
+    /// Returns the boundary points adjacent to the unknowns of the current equation, ordered by
+    /// the unknowns.
+    std::vector<BoundaryTerm> const& boundaryTerms() const noexcept
+    {
+        return _boundaryTerms;
+    }
+
+    /// Returns whether the unknowns of the current equation fill a rectangle surrounded by boundary
+    /// points only, i.e. the five-point Laplacian of a `numColumns` x `numRows` grid.
+    bool IsRectangular(uint32_t& numColumns, uint32_t& numRows) const noexcept
+    {
+        numColumns = _numColumns;
+        numRows    = _numRows;
+        return _numColumns != 0;
+    }
+
+    /// Orders the unknowns of the current equation by nested dissection of the grid, which keeps
+    /// the fill-in of a factorization of the matrix low.
+    void GetNestedDissectionOrder(std::vector<uint32_t>& order) const;
+
+    /// Solves the equation Ax = b. `x` holds the previous solution if the topology did not change
+    /// since the last simulation, and the guess of `GuessSolution` otherwise. Returns `false` if
+    /// the equation has no unique solution.
+    virtual bool SolveEquation(SparseMatrix const&       A,
                                std::vector<float>&       x,
                                std::vector<float> const& b) noexcept = 0;
 
+    /// Called when the topology changes, before the first solve of the new equation. Spaces may
+    /// store an initial guess in `x`, which holds zeros. `output` may be used as scratch.
+    virtual void GuessSolution(Point const* /*input*/,
+                               float* /*output*/,
+                               std::vector<float>& /*x*/) noexcept
+    {}
+
   private:
     char const* GetErrorMessageInternal(ErrorType errorType) noexcept;
 
     ErrorType RunSimulationInternal(Point const* input, float* output) noexcept;
 
-    bool BuildEquation(Point const* input) noexcept;
+    ErrorType SolveBatchInternal(PointType const*    type,
+                                 float const*        temps,
+                                 size_t              numScenarios,
+                                 float*              results,
+                                 uint32_t            numThreads,
+                                 ThreadPolicy const& policy);
+
+    bool IsSameTopology(Point const* input) const noexcept;
+
+    void BuildMatrix(Point const* input) noexcept;
+
+    /// Assembles the equation of the given point types. Returns whether an unknown borders a wall,
+    /// i.e. an out-of-range point or the edge of the matrix.
+    bool Assemble(Point const*               input,
+                  SparseMatrix&              A,
+                  std::vector<Pos>&          i2Pos,
+                  std::vector<size_t>&       pos2I,
+                  std::vector<BoundaryTerm>& boundaryTerms) const;
+
+    void BuildRightHandSide(Point const* input) noexcept;
 
     void CopyResults(Point const* input, float* output) noexcept;
 };
@@ -4,10 +4,24 @@
 #ifndef LAPLACE_EQ_THERM_SERVER_CORE_MONTE_CARLO_SPACE_HH
 #define LAPLACE_EQ_THERM_SERVER_CORE_MONTE_CARLO_SPACE_HH
 
+#include <leth/Config.hh>
 #include <leth/Space.hh>
+#include <leth/WorkerPool.hh>
+#include <leth/Xoshiro256.hh>
 
-#include <random>
+#include <chrono>
+#include <cstdint>
+#include <vector>
 
+/// Estimates the temperature of each point as the mean boundary temperature reached by random
+/// walks from it. After a few pilot walks per point, walks are allocated in rounds to the points
+/// with the widest confidence intervals, until every standard error meets the target, the walk
+/// budget is spent or the time budget runs out. The standard errors are reported along with the
+/// results.
+///
+/// Walks advance in lanes of a fixed width: every lane takes a step at once, with the directions
+/// of all lanes cut from a single random draw, and walls and boundaries are looked up in a grid
+/// padded with walls, so a step needs no bound checks or branches.
 class MonteCarloSpace : public Space
 {
   private:
@@ -17,21 +31,48 @@ class MonteCarloSpace : public Space
         InvalidEquation,
     };
 
+    /// Represents how a walk treats a point of the padded grid.
+    enum class CellClass : uint8_t
+    {
+        Interior,
+        Absorbing,
+        Reflecting,
+    };
+
+    /// Running statistics of the walks from a point, updated with Welford's algorithm
+    struct CellStats
+    {
+        uint32_t numWalks;
+        uint32_t numPendingWalks;
+        double   mean;
+        double   m2;
+    };
+
   private:
-    std::default_random_engine _eng;
-    std::vector<bool>          _sanityCheckVisitMap;
+    uint32_t                  _numWalks;
+    float                     _targetError;
+    std::chrono::milliseconds _timeBudget;
+    WorkerPool                _workers;
+    std::vector<Xoshiro256>   _engines;
+    std::vector<bool>         _sanityCheckVisitMap;
+    std::vector<uint32_t>     _sanityCheckStack;
+    std::vector<uint32_t>     _cells;
+    std::vector<CellStats>    _cellStats;
+    std::vector<CellClass>    _paddedCells;
+    std::vector<float>        _paddedTemps;
 
   public:
-    MonteCarloSpace(uint16_t width, uint16_t height) :
-        Space { width, height },
-        _eng { std::random_device {}() }
-    {}
+    MonteCarloSpace(uint16_t width, uint16_t height, SpaceConfig const& config = {});
 
   protected:
     virtual char const* GetName() noexcept override;
 
     virtual char const* GetErrorMessage(ErrorCode errorCode) noexcept override;
 
+    virtual bool EstimatesErrors() noexcept override;
+
+    virtual void SetThreadPolicy(ThreadPolicy const& policy) noexcept override;
+
     virtual ErrorCode RunSimulation(Point const* input, float* output) noexcept override;
 
   private:
@@ -39,9 +80,21 @@ class MonteCarloSpace : public Space
 
     ErrorType RunSimulationInternal(Point const* input, float* output) noexcept;
 
-    bool CheckSanity(Point const* input, uint16_t i, uint16_t j) noexcept;
+    /// Returns whether every unknown point is connected to a boundary.
+    bool CheckSanity(Point const* input) noexcept;
+
+    /// Classifies the points of the input into a grid with a border of walls.
+    void BuildPaddedGrid(Point const* input) noexcept;
+
+    /// Runs the pending walks of every point in parallel.
+    void RunPendingWalks() noexcept;
+
+    /// Runs the pending walks of the points [`begin`, `end`) of `_cells`.
+    void RunWalks(size_t begin, size_t end, Xoshiro256& eng) noexcept;
 
-    float DoMonteCarlo(Point const* input, uint16_t i, uint16_t j) noexcept;
+    /// Returns the estimated variance of the mean of a point. `pooledVariance` acts as a prior
+    /// sample, so a point whose few walks happened to agree is not taken as exact.
+    double GetVarianceOfMean(CellStats const& cell, double pooledVariance) const noexcept;
 };
 
 #endif
\ No newline at end of file
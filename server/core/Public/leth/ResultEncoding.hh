@@ -0,0 +1,69 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_RESULT_ENCODING_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_RESULT_ENCODING_HH
+
+#include <cstddef>
+#include <cstdint>
+
+/// Represents the options of an encoded simulation result. Options are combined as bit flags.
+enum class ResultEncodingFlag : uint32_t
+{
+    /// Quantizes the values to 16 bits with a per-frame scale and offset only.
+    None = 0,
+    /// Stores the difference from a reference frame instead of the values themselves. The
+    /// reference must be a frame encoded without this flag.
+    Delta = 1,
+    /// Compresses the quantized values with an adaptive Rice coder.
+    Entropy = 2,
+};
+
+/// Returns the maximum size of `length` values encoded by `EncodeResult`.
+size_t GetEncodedResultBound(size_t length) noexcept;
+
+/// Encodes `length` values into `out`, which must be at least `GetEncodedResultBound(length)`
+/// bytes long. Values are quantized to 16 bits between the minimum and the maximum finite value.
+/// If `Delta` is requested but `reference` is not a compatible frame, a self-contained frame is
+/// written instead. Returns the number of bytes written, or 0 on failure.
+///
+/// # Arguments
+///
+/// * `temp`: the values to encode
+/// * `length`: the number of values
+/// * `generation`: the input generation the values were computed from
+/// * `flags`: a combination of `ResultEncodingFlag`s
+/// * `reference`: a previously encoded frame used by `Delta`. May be null.
+/// * `referenceSize`: the size of `reference` in bytes
+/// * `out`: the buffer to store the encoded frame
+/// * `maxError`: the variable to store the maximum absolute quantization error
+size_t EncodeResult(float const*   temp,
+                    size_t         length,
+                    uint64_t       generation,
+                    uint32_t       flags,
+                    uint8_t const* reference,
+                    size_t         referenceSize,
+                    uint8_t*       out,
+                    float*         maxError) noexcept;
+
+/// Decodes a frame written by `EncodeResult`. Returns `false` if the frame is malformed, has a
+/// different number of values, or is a delta frame whose reference is not given.
+///
+/// # Arguments
+///
+/// * `encoded`: the encoded frame
+/// * `encodedSize`: the size of `encoded` in bytes
+/// * `reference`: the frame `encoded` was encoded against. May be null for self-contained frames.
+/// * `referenceSize`: the size of `reference` in bytes
+/// * `temp`: the buffer to store the decoded values
+/// * `length`: the number of values
+/// * `generation`: the variable to store the generation of the frame. May be null.
+bool DecodeResult(uint8_t const* encoded,
+                  size_t         encodedSize,
+                  uint8_t const* reference,
+                  size_t         referenceSize,
+                  float*         temp,
+                  size_t         length,
+                  uint64_t*      generation) noexcept;
+
+#endif
@@ -0,0 +1,128 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_RESULT_FRAME_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_RESULT_FRAME_HH
+
+#include <leth/IntegerTypes.hh>
+#include <leth/SpaceStats.hh>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ResultFramePool;
+
+/// `ResultFrame` holds a simulation result. A frame is filled by exactly one solver and is never
+/// modified after it is published, so readers can share it without copying. Frames are reference
+/// counted and go back to their pool when the last reference is released.
+class ResultFrame
+{
+    friend class ResultFramePool;
+
+  private:
+    ResultFramePool*      _pool;
+    std::atomic<uint32_t> _refCount;
+    std::vector<float>    _temp;
+    std::vector<float>    _standardErrors;
+    ErrorCode             _errorCode;
+    uint64_t              _generation;
+    SpaceStats            _stats;
+
+  private:
+    ResultFrame(ResultFramePool* pool, size_t length, bool hasStandardErrors);
+
+  public:
+    /// Returns the simulated temperature of all points
+    float const* temp() const noexcept
+    {
+        return _temp.data();
+    }
+
+    /// Returns the estimated standard error of all points, or null if the space does not estimate
+    /// errors
+    float const* standardErrors() const noexcept
+    {
+        return _standardErrors.empty() ? nullptr : _standardErrors.data();
+    }
+
+    /// Returns the error code returned by the solver
+    ErrorCode errorCode() const noexcept
+    {
+        return _errorCode;
+    }
+
+    /// Returns the generation of the input the result was computed from
+    uint64_t generation() const noexcept
+    {
+        return _generation;
+    }
+
+    /// Returns the statistics of the simulation
+    SpaceStats const& stats() const noexcept
+    {
+        return _stats;
+    }
+
+    /// Returns the buffer to be filled before the frame is published.
+    float* data() noexcept
+    {
+        return _temp.data();
+    }
+
+    /// Returns the buffer of standard errors to be filled before the frame is published, or null
+    /// if the space does not estimate errors.
+    float* standardErrorData() noexcept
+    {
+        return _standardErrors.empty() ? nullptr : _standardErrors.data();
+    }
+
+    /// Sets the result metadata before the frame is published.
+    void SetResult(ErrorCode errorCode, uint64_t generation, SpaceStats const& stats) noexcept
+    {
+        _errorCode  = errorCode;
+        _generation = generation;
+        _stats      = stats;
+    }
+
+    /// Adds a reference.
+    void Retain() noexcept
+    {
+        _refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Removes a reference. The frame returns to its pool when no reference is left.
+    void Release() noexcept;
+};
+
+/// `ResultFramePool` recycles the frames of a space so that publishing a result does not allocate
+/// once the number of frames in flight has stabilized. The pool must outlive its frames.
+class ResultFramePool
+{
+    friend class ResultFrame;
+
+  private:
+    size_t                                    _length;
+    bool                                      _hasStandardErrors;
+    std::mutex                                _lock;
+    std::vector<std::unique_ptr<ResultFrame>> _frames;
+    std::vector<ResultFrame*>                 _freeFrames;
+
+  public:
+    ResultFramePool(size_t length, bool hasStandardErrors = false);
+    ResultFramePool(ResultFramePool const&) = delete;
+    ResultFramePool& operator=(ResultFramePool const&) = delete;
+
+  public:
+    /// Returns a frame holding a single reference. Its contents are those of an earlier result of
+    /// the same pool, or zeros for a new frame.
+    ResultFrame* Acquire();
+
+  private:
+    void Return(ResultFrame* frame) noexcept;
+};
+
+#endif
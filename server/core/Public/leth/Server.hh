@@ -4,12 +4,19 @@
 #ifndef LAPLACE_EQ_THERM_SERVER_CORE_SERVER_HH
 #define LAPLACE_EQ_THERM_SERVER_CORE_SERVER_HH
 
+#include <leth/Config.hh>
 #include <leth/IntegerTypes.hh>
+#include <leth/Journal.hh>
+#include <leth/ResultFrame.hh>
+#include <leth/SharedResults.hh>
 #include <leth/Space.hh>
+#include <leth/SpaceRegistry.hh>
+#include <leth/ThreadPolicy.hh>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
-#include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -27,6 +34,15 @@ class Server
         PointType type;
     };
 
+    /// The simulation a space thread is running, for publishing its previews
+    struct RunContext
+    {
+        Server*                               server;
+        size_t                                spaceIdx;
+        uint64_t                              generation;
+        std::chrono::steady_clock::time_point start;
+    };
+
   public:
     template <typename... ArgsT,
               typename std::enable_if<(std::is_base_of<Space, ArgsT>::value && ...), int>::type = 0>
@@ -39,25 +55,42 @@ class Server
         return new Server { width, height, std::move(rtn) };
     }
 
+    /// Creates a server running the spaces listed in `config`. Returns null if a space is not in
+    /// `registry`.
+    static Server* Make(ServerConfig const& config, SpaceRegistry const& registry);
+
   private:
     uint16_t                            _width, _height;
     std::vector<std::unique_ptr<Space>> _spaces;
     std::atomic_bool                    _stopped;
+    uint32_t                            _flags;
+    ThreadPolicy                        _solverPolicy, _ingestionPolicy;
 
-    std::mutex                  _requestQueueLock;
-    std::deque<SetPointRequest> _requestQueue;
-    std::thread                 _queueConsumerThread;
+    std::mutex                   _requestQueueLock;
+    std::condition_variable      _requestQueueChanged;
+    std::vector<SetPointRequest> _requestQueue;
+    std::thread                  _queueConsumerThread;
 
     std::mutex               _inputBufferLock;
+    std::condition_variable  _inputChanged;
     std::vector<Point>       _inputBuffer;
+    std::atomic<uint64_t>    _inputGeneration;
     std::vector<std::thread> _spaceThreads;
 
-    std::vector<std::mutex>         _outputBufferLocks;
-    std::vector<std::vector<float>> _outputBuffers;
-    std::vector<ErrorCode>          _outputResults;
+    std::vector<std::unique_ptr<ResultFramePool>> _framePools;
+    std::vector<std::mutex>                       _outputFrameLocks;
+    std::vector<ResultFrame*>                     _outputFrames;
+
+    Journal               _journal;
+    SharedResultPublisher _sharedResults;
 
   private:
-    Server(uint16_t width, uint16_t height, std::vector<std::unique_ptr<Space>>&& spaces);
+    Server(uint16_t                              width,
+           uint16_t                              height,
+           std::vector<std::unique_ptr<Space>>&& spaces,
+           uint32_t                              flags           = 0,
+           ThreadPolicy const&                   solverPolicy    = {},
+           ThreadPolicy const&                   ingestionPolicy = {});
     Server(Server const&) = delete;
     Server& operator=(Server const&) = delete;
 
@@ -65,12 +98,47 @@ class Server
     ~Server() noexcept;
 
   public:
-    SpaceIndex  GetNumberOfSpaces() noexcept;
-    char const* GetSpaceName(SpaceIndex spaceIdx) noexcept;
-    char const* GetErrorMessage(SpaceIndex spaceIdx, ErrorCode errorCode) noexcept;
-    void        SetPoint(uint16_t x, uint16_t y, float temp, PointType type) noexcept;
-    void        GetPoints(float* temp, PointType* type) noexcept;
-    ErrorCode   GetSimulationResult(SpaceIndex spaceIdx, float* temp) noexcept;
+    SpaceIndex   GetNumberOfSpaces() noexcept;
+    char const*  GetSpaceName(SpaceIndex spaceIdx) noexcept;
+    char const*  GetErrorMessage(SpaceIndex spaceIdx, ErrorCode errorCode) noexcept;
+    void         SetPoint(uint16_t x, uint16_t y, float temp, PointType type) noexcept;
+    void         GetPoints(float* temp, PointType* type) noexcept;
+    uint64_t     GetSnapshot(float*     temp,
+                             PointType* type,
+                             float*     results,
+                             ErrorCode* errorCodes,
+                             uint64_t*  generations) noexcept;
+    ErrorCode    GetSimulationResult(SpaceIndex spaceIdx, float* temp) noexcept;
+    uint64_t     GetGeneration() noexcept;
+    ErrorCode    GetSimulationResult(SpaceIndex spaceIdx,
+                                     float*     temp,
+                                     uint64_t*  generation) noexcept;
+    ResultFrame* AcquireSimulationResult(SpaceIndex spaceIdx) noexcept;
+    void         ReleaseSimulationResult(ResultFrame* frame) noexcept;
+    ErrorCode    GetSimulationStats(SpaceIndex spaceIdx, SpaceStats* stats) noexcept;
+    bool         GetSimulationError(SpaceIndex spaceIdx, float* error) noexcept;
+    ErrorCode    SolveBatch(SpaceIndex       spaceIdx,
+                            PointType const* type,
+                            float const*     temps,
+                            uint32_t         numScenarios,
+                            float*           results,
+                            uint32_t         numThreads) noexcept;
+    size_t       GetEncodedSimulationResultBound() noexcept;
+    ErrorCode    GetEncodedSimulationResult(SpaceIndex     spaceIdx,
+                                            uint32_t       flags,
+                                            uint8_t const* reference,
+                                            size_t         referenceSize,
+                                            uint8_t*       buffer,
+                                            size_t         bufferSize,
+                                            size_t*        encodedSize,
+                                            float*         maxError) noexcept;
+    bool         StartJournal(char const* path,
+                              uint64_t    maxFileSize,
+                              uint32_t    checkpointIntervalMs) noexcept;
+    void         StopJournal() noexcept;
+    uint64_t     GetJournalDropped() noexcept;
+    bool         StartSharedResults(char const* name, uint32_t numSlots) noexcept;
+    void         StopSharedResults() noexcept;
 
   private:
     inline size_t GetBufferLength() noexcept
@@ -79,6 +147,8 @@ class Server
     }
     void ConsumeQueue() noexcept;
     void CopyBufferAndRunSimulation(size_t idx, Space* space) noexcept;
+    void PublishSimulationResult(size_t idx, ResultFrame* frame) noexcept;
+    static void PublishPreview(void* context, float const* temp, uint32_t resolutionLevel) noexcept;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,201 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_SHARED_RESULTS_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_SHARED_RESULTS_HH
+
+#include <leth/IntegerTypes.hh>
+#include <leth/Point.hh>
+#include <leth/SpaceStats.hh>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The shared results need lock-free 64-bit atomics to work across processes");
+
+/// The header at the start of a shared result region. The region is followed by one channel for
+/// the input and one for each space, `channelSize` bytes each.
+struct alignas(64) SharedResultsHeader
+{
+    /// "LETHSHRD" in little endian
+    static constexpr uint64_t Magic { 0x4452485348544554 };
+    static constexpr uint32_t Version { 1 };
+    /// Number of frames of a channel unless given otherwise
+    static constexpr uint32_t DefaultNumSlots { 4 };
+
+    uint64_t magic;
+    uint32_t version;
+    uint16_t width, height;
+    uint32_t numSpaces;
+    uint32_t numSlots;
+    uint64_t frameSize;
+    uint64_t channelSize;
+};
+
+/// The header of a channel, followed by a ring of `numSlots` frames of `frameSize` bytes.
+struct alignas(64) SharedChannelHeader
+{
+    /// Version of the latest complete frame, starting from 1. Frame `v` is in slot `(v - 1) %
+    /// numSlots`. Zero if nothing was published yet.
+    std::atomic<uint64_t> latest;
+};
+
+/// The header of a frame, followed by `width` * `height` temperatures and, in the input channel,
+/// `width` * `height` point types.
+struct alignas(64) SharedFrameHeader
+{
+    /// `2v - 1` while frame `v` is written to the slot and `2v` once it is complete
+    std::atomic<uint64_t> sequence;
+    uint64_t              generation;
+    ErrorCode             errorCode;
+    SpaceStats            stats;
+};
+
+/// `SharedResultPublisher` writes the input and the latest result of every space of a `Server`
+/// into a POSIX shared memory object, so that local processes can read them without going through
+/// the server. Every channel is a ring of versioned frames guarded by sequence numbers: readers
+/// never block the publisher, and detect a frame overwritten while they were reading it. Publishing
+/// copies the values once and does not allocate.
+///
+/// Does nothing on platforms without POSIX shared memory.
+class SharedResultPublisher
+{
+  private:
+    uint16_t   _width, _height;
+    SpaceIndex _numSpaces;
+
+    std::mutex              _controlLock;
+    std::atomic_bool        _active;
+    std::vector<std::mutex> _channelLocks;
+
+    std::string _name;
+    uint8_t*    _region;
+    size_t      _regionSize;
+    uint64_t    _device, _inode;
+    uint32_t    _numSlots;
+    size_t      _frameSize, _channelSize;
+
+  public:
+    SharedResultPublisher(uint16_t width, uint16_t height, SpaceIndex numSpaces);
+    SharedResultPublisher(SharedResultPublisher const&) = delete;
+    SharedResultPublisher& operator=(SharedResultPublisher const&) = delete;
+    ~SharedResultPublisher() noexcept;
+
+  public:
+    /// Creates the shared memory object `name` with a ring of `numSlots` frames per channel (0 for
+    /// the default). An existing object of the same name is unlinked first; readers that mapped it
+    /// keep it until they open the name again. Returns `false` if the publisher is already running
+    /// or the object cannot be created.
+    bool Start(char const* name, uint32_t numSlots) noexcept;
+
+    /// Unmaps the shared memory object and removes its name, unless another publisher has replaced
+    /// it since. Readers keep their mapping, but no longer receive frames.
+    void Stop() noexcept;
+
+    /// Returns whether frames are being published.
+    bool IsActive() const noexcept
+    {
+        return _active.load(std::memory_order_acquire);
+    }
+
+    /// Publishes the input. Must be called from a single thread at a time.
+    void PublishInput(Point const* input, uint64_t generation) noexcept;
+
+    /// Publishes a result of the given space. Must be called from a single thread at a time per
+    /// space.
+    void PublishResult(SpaceIndex        spaceIdx,
+                       ErrorCode         errorCode,
+                       uint64_t          generation,
+                       SpaceStats const& stats,
+                       float const*      temp) noexcept;
+
+  private:
+    SharedFrameHeader* BeginFrame(size_t channelIdx, uint64_t& version) noexcept;
+    void EndFrame(size_t channelIdx, SharedFrameHeader* frame, uint64_t version) noexcept;
+};
+
+/// A frame of a shared result region, read in place. The publisher may overwrite it after it
+/// goes around the ring, so the values must be checked with `SharedResultReader::IsValid` after
+/// they are read.
+struct SharedResultView
+{
+    /// Version of the frame in its channel
+    uint64_t version;
+    /// Generation of the input
+    uint64_t generation;
+    /// Error code of the result. Zero for the input.
+    ErrorCode errorCode;
+    /// Statistics of the simulation. Zero for the input.
+    SpaceStats stats;
+    /// `width` * `height` temperatures
+    float const* temp;
+    /// `width` * `height` point types. Null for results.
+    PointType const* type;
+
+    SharedFrameHeader const* frame;
+};
+
+/// `SharedResultReader` reads the frames written by `SharedResultPublisher` in another process.
+class SharedResultReader
+{
+  private:
+    uint8_t const* _region;
+    size_t         _regionSize;
+    uint16_t       _width, _height;
+    SpaceIndex     _numSpaces;
+    uint32_t       _numSlots;
+    size_t         _frameSize, _channelSize;
+
+  public:
+    SharedResultReader();
+    SharedResultReader(SharedResultReader const&) = delete;
+    SharedResultReader& operator=(SharedResultReader const&) = delete;
+    ~SharedResultReader() noexcept;
+
+  public:
+    /// Maps the shared memory object `name` read-only. Returns `false` if it does not exist or
+    /// was not written by a compatible publisher.
+    bool Open(char const* name) noexcept;
+
+    /// Unmaps the shared memory object.
+    void Close() noexcept;
+
+    /// Returns the width of the matrix
+    uint16_t width() const noexcept
+    {
+        return _width;
+    }
+
+    /// Returns the height of the matrix
+    uint16_t height() const noexcept
+    {
+        return _height;
+    }
+
+    /// Returns the number of spaces of the server
+    SpaceIndex numSpaces() const noexcept
+    {
+        return _numSpaces;
+    }
+
+    /// Gets the latest input without copying it. Returns `false` if nothing was published yet.
+    bool AcquireInput(SharedResultView& view) const noexcept;
+
+    /// Gets the latest result of the given space without copying it. Returns `false` if the
+    /// space index is invalid or nothing was published yet.
+    bool AcquireResult(SpaceIndex spaceIdx, SharedResultView& view) const noexcept;
+
+    /// Returns whether the frame of `view` is unchanged since it was acquired, i.e. whether the
+    /// values read from it so far are consistent.
+    bool IsValid(SharedResultView const& view) const noexcept;
+
+  private:
+    bool Acquire(size_t channelIdx, SharedResultView& view) const noexcept;
+};
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_SINE_TRANSFORM_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_SINE_TRANSFORM_HH
+
+#include <leth/Fft.hh>
+
+#include <cstddef>
+#include <vector>
+
+/// `SineTransform` computes the type-I discrete sine transform of a fixed length n,
+/// y_k = Σ x_j sin(π jk / (n + 1)) for j, k = 1..n. Its basis vectors are the eigenvectors of the
+/// second difference with zero ends, and applying it twice scales by (n + 1) / 2.
+///
+/// The transform is read off a Fourier transform of n + 1 points of a real sequence folded from
+/// the input, so two inputs are transformed at once, one as the real and one as the imaginary
+/// part.
+class SineTransform
+{
+  private:
+    size_t                    _length;
+    Fft                       _fft;
+    std::vector<double>       _sines;
+    std::vector<Fft::Complex> _buffer;
+
+  public:
+    explicit SineTransform(size_t length = 0);
+
+  public:
+    /// Returns the number of points of the transform
+    size_t length() const noexcept
+    {
+        return _length;
+    }
+
+    /// Replaces the sequences of `length()` points with their transforms.
+    ///
+    /// # Arguments
+    ///
+    /// * `first`: the first sequence
+    /// * `second`: the second sequence. May be null.
+    void Transform(double* first, double* second) noexcept;
+};
+
+#endif
@@ -6,6 +6,8 @@
 
 #include <leth/IntegerTypes.hh>
 #include <leth/Point.hh>
+#include <leth/SpaceStats.hh>
+#include <leth/ThreadPolicy.hh>
 
 #include <cstddef>
 #include <cstdint>
@@ -15,8 +17,16 @@ class Space
 {
     friend class Server;
 
+  public:
+    /// Receives a preview of the current simulation. `temp` holds every point.
+    using PreviewCallback = void (*)(void* context, float const* temp, uint32_t resolutionLevel);
+
   private:
-    uint16_t _width, _height;
+    uint16_t        _width, _height;
+    SpaceStats      _stats;
+    float*          _standardErrors;
+    PreviewCallback _previewCallback;
+    void*           _previewContext;
 
   protected:
     /// Returns the width of the input and the output matrix
@@ -31,8 +41,41 @@ class Space
         return _height;
     }
 
+    /// Returns the statistics of the current simulation. Reset before every simulation.
+    SpaceStats& stats() noexcept
+    {
+        return _stats;
+    }
+
+    /// Returns the buffer to store the estimated standard error of every point during a
+    /// simulation. Null unless `EstimatesErrors` returns `true`.
+    float* standardErrors() noexcept
+    {
+        return _standardErrors;
+    }
+
+    /// Publishes an approximate result before the simulation finishes, along with the current
+    /// statistics. Does nothing unless the space is run by a server.
+    ///
+    /// # Arguments
+    ///
+    /// * `temp`: the temperatures of every point, like the output of `RunSimulation`
+    /// * `resolutionLevel`: `n` if the result was solved on a grid coarsened by 2^n
+    void PublishPreview(float const* temp, uint32_t resolutionLevel) noexcept
+    {
+        if (_previewCallback != nullptr)
+            _previewCallback(_previewContext, temp, resolutionLevel);
+    }
+
   public:
-    Space(uint16_t width, uint16_t height) : _width { width }, _height { height } {}
+    Space(uint16_t width, uint16_t height) :
+        _width { width },
+        _height { height },
+        _stats {},
+        _standardErrors { nullptr },
+        _previewCallback { nullptr },
+        _previewContext { nullptr }
+    {}
 
   protected:
     /// Returns the name of this space. Must be a static string.
@@ -41,9 +84,50 @@ class Space
     /// Returns the error message corresponding to the given error code. Must be a static string.
     virtual char const* GetErrorMessage(ErrorCode errorCode) noexcept = 0;
 
-    // Runs the simulation.
+    /// Returns whether this space estimates the standard error of its results.
+    virtual bool EstimatesErrors() noexcept
+    {
+        return false;
+    }
+
+    /// Returns whether the latest result is final, i.e. simulating the same input again would not
+    /// improve it. Iterative solvers stopped by their iteration limit have not converged.
+    virtual bool HasConverged() noexcept
+    {
+        return true;
+    }
+
+    /// Applies the scheduling policy of the server to the threads started by this space. The
+    /// server applies it to the thread running the simulation itself.
+    virtual void SetThreadPolicy(ThreadPolicy const& /*policy*/) noexcept {}
+
+    /// Runs the simulation. `output` holds an earlier result of this space, not necessarily the
+    /// latest one, so every point the space reports must be written.
     virtual ErrorCode RunSimulation(Point const* input, float* output) noexcept = 0;
 
+    /// Solves several inputs sharing the point types at once. Called on another thread while the
+    /// simulation runs, so it must not touch the state of the simulation. Returns
+    /// `BatchNotSupportedError` unless the space supports batches.
+    ///
+    /// # Arguments
+    ///
+    /// * `type`: the point types of every point
+    /// * `temps`: the temperatures of every point of each input, one input after another. Only
+    ///            boundary points are read.
+    /// * `numScenarios`: the number of inputs
+    /// * `results`: the buffer to store the result of each input, one after another
+    /// * `numThreads`: the number of threads to solve with
+    /// * `policy`: the scheduling policy of the threads started for the batch
+    virtual ErrorCode SolveBatch(PointType const* /*type*/,
+                                 float const* /*temps*/,
+                                 size_t /*numScenarios*/,
+                                 float* /*results*/,
+                                 uint32_t /*numThreads*/,
+                                 ThreadPolicy const& /*policy*/) noexcept
+    {
+        return BatchNotSupportedError;
+    }
+
     /// Returns the index of the element of the input and output buffer corresponding to (i, j).
     size_t GetIndex(uint16_t i, uint16_t j) const noexcept
     {
@@ -59,13 +143,26 @@ class Space
     /// Returns whether the point (i, j) is inside the matrix.
     bool Inside(uint16_t i, uint16_t j) const noexcept
     {
-        return i < _width && j < _height;
+        return i < _height && j < _width;
     }
 
     /// Returns whether the point (i, j) is inside the matrix.
     bool Inside(int32_t i, int32_t j) const noexcept
     {
-        return 0 <= i && i < _width && 0 <= j && j < _height;
+        return 0 <= i && i < _height && 0 <= j && j < _width;
+    }
+
+    /// Returns a hash of the point types of the input. Inputs with the same hash have the same
+    /// geometry and differ in temperatures only.
+    uint64_t GetTopologyHash(Point const* input) const noexcept
+    {
+        uint64_t hash { 0xcbf29ce484222325 };
+        for (size_t i { 0 }, iEnd { static_cast<size_t>(_width) * _height }; i < iEnd; ++i)
+        {
+            hash ^= static_cast<uint8_t>(input[i].type);
+            hash *= 0x100000001b3;
+        }
+        return hash ^ (static_cast<uint64_t>(_width) << 32) ^ _height;
     }
 
   public:
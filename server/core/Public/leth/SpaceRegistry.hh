@@ -0,0 +1,59 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_SPACE_REGISTRY_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_SPACE_REGISTRY_HH
+
+#include <leth/Config.hh>
+#include <leth/Space.hh>
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/// `SpaceRegistry` maps names to the factories of spaces, so the set of spaces a server runs can
+/// be chosen at runtime.
+class SpaceRegistry
+{
+  public:
+    using Factory = std::unique_ptr<Space> (*)(uint16_t           width,
+                                               uint16_t           height,
+                                               SpaceConfig const& config);
+
+  private:
+    struct Entry
+    {
+        char const* name;
+        Factory     factory;
+    };
+
+  private:
+    std::vector<Entry> _entries;
+
+  public:
+    /// Returns the registry holding every space of this library.
+    static SpaceRegistry const& GetDefault();
+
+  public:
+    /// Registers `SpaceT` under `name`, which must be a static string. `SpaceT` must be
+    /// constructible from `(uint16_t width, uint16_t height, SpaceConfig const& config)`.
+    template <typename SpaceT,
+              typename std::enable_if<std::is_base_of<Space, SpaceT>::value, int>::type = 0>
+    void Register(char const* name)
+    {
+        _entries.push_back(Entry {
+            name,
+            [](uint16_t           width,
+               uint16_t           height,
+               SpaceConfig const& config) -> std::unique_ptr<Space> {
+                return std::make_unique<SpaceT>(width, height, config);
+            },
+        });
+    }
+
+    /// Creates the space registered under `config.name`. Returns null if there is no such space.
+    std::unique_ptr<Space> Create(uint16_t width, uint16_t height, SpaceConfig const& config) const;
+};
+
+#endif
@@ -0,0 +1,27 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_SPACE_STATS_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_SPACE_STATS_HH
+
+#include <cstdint>
+
+/// Represents the statistics of the simulation that produced a result. Fields a space does not
+/// report are zero.
+struct SpaceStats
+{
+    /// Wall time of the simulation in microseconds
+    uint64_t elapsedUs;
+    /// Number of sweeps of an iterative solver
+    uint32_t numIterations;
+    /// Relaxation factor used by `SuccessiveOverRelaxationSpace`
+    float omega;
+    /// Number of samples of a stochastic solver, e.g. the random walks of `MonteCarloSpace`
+    uint64_t numSamples;
+    /// Largest estimated standard error of a point
+    float maxStandardError;
+    /// Zero for a full-resolution result. A preview solved on a grid coarsened by 2^n has level n.
+    uint32_t resolutionLevel;
+};
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_SPARSE_CHOLESKY_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_SPARSE_CHOLESKY_HH
+
+#include <leth/SparseMatrix.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// `SparseCholesky` factorizes a symmetric definite matrix as P A Pᵀ = L D Lᵀ, where P is a
+/// given elimination order, L is unit lower triangular and D is diagonal. A good order keeps L
+/// sparse; solving with the factorization then costs two triangular solves over the nonzeros of L.
+class SparseCholesky
+{
+  private:
+    std::vector<uint32_t> _order, _orderInv;
+    std::vector<int32_t>  _parent;
+    std::vector<size_t>   _columnStarts;
+    std::vector<uint32_t> _rows;
+    std::vector<double>   _values;
+    std::vector<double>   _diagonal;
+
+  public:
+    /// Returns the number of rows of the factorized matrix
+    size_t size() const noexcept
+    {
+        return _diagonal.size();
+    }
+
+    /// Returns the number of nonzeros of L, excluding the unit diagonal
+    size_t GetNumNonzeros() const noexcept
+    {
+        return _values.size();
+    }
+
+    /// Factorizes `A`, eliminating the rows in the given order. `A` must be symmetric. Returns
+    /// `false` if `A` is singular or indefinite, in which case the factorization is empty.
+    ///
+    /// # Arguments
+    ///
+    /// * `A`: the matrix to factorize
+    /// * `order`: the rows of `A` in the order of elimination
+    bool Factorize(SparseMatrix const& A, std::vector<uint32_t> const& order);
+
+    /// Solves Ax = b. `b` and `x` may be the same buffer.
+    ///
+    /// # Arguments
+    ///
+    /// * `b`: the right-hand side
+    /// * `x`: the buffer to store the solution
+    /// * `work`: a scratch buffer of `size()` elements
+    void Solve(float const* b, float* x, double* work) const noexcept;
+
+    /// Solves Ax = b for several right-hand sides at once, stored one after another. The
+    /// triangular solves sweep L once for all of them, so a block of right-hand sides costs little
+    /// more memory traffic than one. `b` and `x` may be the same buffer.
+    ///
+    /// # Arguments
+    ///
+    /// * `b`: the right-hand sides, `size()` elements each
+    /// * `x`: the buffer to store the solutions, `size()` elements each
+    /// * `numRhs`: the number of right-hand sides
+    /// * `work`: a scratch buffer of `size()` * `numRhs` elements
+    void Solve(float const* b, float* x, size_t numRhs, double* work) const noexcept;
+
+    /// Removes the factorization.
+    void Clear() noexcept;
+};
+
+#endif
@@ -0,0 +1,36 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_SPARSE_MATRIX_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_SPARSE_MATRIX_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Represents a square matrix in the compressed sparse row format. The diagonal is stored apart
+/// from the other entries, so a row holds its off-diagonal entries only.
+struct SparseMatrix
+{
+    std::vector<float>    diagonal;
+    std::vector<uint32_t> rowStarts;
+    std::vector<uint32_t> columns;
+    std::vector<float>    values;
+
+    /// Returns the number of rows
+    size_t size() const noexcept
+    {
+        return diagonal.size();
+    }
+
+    /// Removes every row. Keeps the allocated memory.
+    void Clear() noexcept
+    {
+        diagonal.clear();
+        rowStarts.clear();
+        columns.clear();
+        values.clear();
+    }
+};
+
+#endif
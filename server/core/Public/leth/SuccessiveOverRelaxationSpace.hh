@@ -6,19 +6,86 @@
 
 #include <leth/MatrixSpace.hh>
 
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
+/// Solves the equation with successive over-relaxation. Unless a relaxation factor is configured,
+/// the optimal factor is derived from the spectral radius of the Jacobi iteration, which is
+/// computed from the geometry of rectangular domains or estimated from the first Gauss-Seidel
+/// sweeps otherwise. The estimate is cached per topology and refined from the convergence rate
+/// of every solve.
+///
+/// With a preview scale, the first solve of a new topology is preceded by a solve on a coarser
+/// grid. Its upsampled result is published as a preview and used as the initial guess, which
+/// removes most of the smooth error that SOR is slow to reduce.
 class SuccessiveOverRelaxationSpace : public MatrixSpace
 {
+  private:
+    struct CachedJacobiRadius
+    {
+        std::vector<PointType> pointTypes;
+        float                  radius;
+    };
+
+  private:
+    float                                            _omega;
+    float                                            _tolerance;
+    uint32_t                                         _maxIterations;
+    std::unordered_map<uint64_t, CachedJacobiRadius> _jacobiRadii;
+    bool                                             _converged;
+
+    // Preview
+    uint32_t                                       _previewScale;
+    uint32_t                                       _previewLevel;
+    std::unique_ptr<SuccessiveOverRelaxationSpace> _coarseSpace;
+    std::vector<Point>                             _coarseInput;
+    std::vector<float>                             _coarseOutput;
+
   public:
-    using MatrixSpace::MatrixSpace;
+    SuccessiveOverRelaxationSpace(uint16_t width, uint16_t height, SpaceConfig const& config = {});
 
   protected:
     virtual char const* GetName() noexcept override final;
 
-    virtual void SolveEquation(std::vector<float> const& A,
+    virtual bool HasConverged() noexcept override final;
+
+    virtual bool SolveEquation(SparseMatrix const&       A,
                                std::vector<float>&       x,
                                std::vector<float> const& b) noexcept override final;
+
+    virtual void GuessSolution(Point const*        input,
+                               float*              output,
+                               std::vector<float>& x) noexcept override final;
+
+  private:
+    /// Runs a sweep and returns the largest change of the unknowns.
+    float Sweep(SparseMatrix const&       A,
+                std::vector<float>&       x,
+                std::vector<float> const& b,
+                float                     omega) noexcept;
+
+    /// Estimates the spectral radius of the Jacobi iteration by running Gauss-Seidel sweeps.
+    float EstimateJacobiRadius(SparseMatrix const&       A,
+                               std::vector<float>&       x,
+                               std::vector<float> const& b,
+                               uint32_t&                 numIterations) noexcept;
+
+    /// Returns the cached Jacobi radius of the current topology, or null if there is none.
+    float* FindJacobiRadius() noexcept;
+
+    /// Caches the Jacobi radius of the current topology. Returns null on failure.
+    float* CacheJacobiRadius(float radius) noexcept;
+
+    /// Coarsens the input into `_coarseInput`. A coarse point is a boundary at the mean
+    /// temperature of the boundaries it covers, if any, and otherwise unknown if it covers an
+    /// unknown.
+    void BuildCoarseInput(Point const* input) noexcept;
+
+    /// Interpolates the coarse solution bilinearly at the point (i, j), between the centers of the
+    /// coarse points inside the domain.
+    float InterpolateCoarseOutput(uint16_t i, uint16_t j) const noexcept;
 };
 
 #endif
\ No newline at end of file
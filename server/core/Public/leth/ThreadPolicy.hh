@@ -0,0 +1,26 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_THREAD_POLICY_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_THREAD_POLICY_HH
+
+#include <cstdint>
+
+/// Represents where and how eagerly a thread is scheduled. A zero-initialized policy leaves the
+/// thread as it is.
+struct ThreadPolicy
+{
+    /// Cores the thread may run on, bit n for core n. Zero allows every core.
+    uint64_t cpuMask;
+    /// Nice value of the thread. Negative values need privileges.
+    int32_t nice;
+    /// Whether the thread is scheduled as a CPU-bound batch job, which does not preempt
+    /// interactive threads when it wakes up
+    bool batch;
+};
+
+/// Applies the policy to the calling thread. Every part is attempted even if another fails.
+/// Returns `false` if a part failed or is not supported by the platform.
+bool ApplyThreadPolicy(ThreadPolicy const& policy) noexcept;
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_WORKER_POOL_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_WORKER_POOL_HH
+
+#include <leth/ThreadPolicy.hh>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// `WorkerPool` runs the iterations of a loop on a fixed set of threads. The calling thread takes
+/// part in every loop, so a pool of `n` threads starts `n - 1` threads. Dispatching a loop does
+/// not allocate.
+class WorkerPool
+{
+  private:
+    using Task = void (*)(void* context, size_t idx, uint32_t workerIdx);
+
+  private:
+    std::vector<std::thread> _threads;
+
+    std::mutex              _lock;
+    std::condition_variable _wake, _done;
+    uint64_t                _epoch;
+    uint32_t                _numBusy;
+    bool                    _stopped;
+    ThreadPolicy            _policy;
+    uint64_t                _policyEpoch;
+
+    Task                _task;
+    void*               _context;
+    std::atomic<size_t> _next;
+    size_t              _end;
+
+  public:
+    explicit WorkerPool(uint32_t numThreads);
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+    ~WorkerPool() noexcept;
+
+  public:
+    /// Returns the number of threads including the calling thread
+    uint32_t GetNumThreads() const noexcept
+    {
+        return static_cast<uint32_t>(_threads.size()) + 1;
+    }
+
+    /// Calls `func(idx, workerIdx)` for every `idx` in [`begin`, `end`) and returns when all calls
+    /// have finished. `workerIdx` is less than `GetNumThreads()` and is unique among the calls
+    /// running at the same time. `func` must not throw.
+    template <typename FuncT>
+    void ParallelFor(size_t begin, size_t end, FuncT&& func)
+    {
+        using FuncType = typename std::remove_reference<FuncT>::type;
+
+        if (_threads.empty() || end - begin <= 1)
+        {
+            for (size_t idx { begin }; idx < end; ++idx) func(idx, 0);
+            return;
+        }
+
+        Run(
+            begin,
+            end,
+            [](void* context, size_t idx, uint32_t workerIdx) {
+                (*static_cast<FuncType*>(context))(idx, workerIdx);
+            },
+            const_cast<void*>(static_cast<void const*>(&func)));
+    }
+
+    /// Applies the policy to the threads of the pool, except the calling thread, when they start
+    /// the next loop.
+    void SetThreadPolicy(ThreadPolicy const& policy) noexcept;
+
+  private:
+    void Run(size_t begin, size_t end, Task task, void* context) noexcept;
+    void Work(uint32_t workerIdx) noexcept;
+    void RunTasks(uint32_t workerIdx) noexcept;
+};
+
+#endif
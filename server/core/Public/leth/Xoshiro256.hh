@@ -0,0 +1,56 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_XOSHIRO256_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_XOSHIRO256_HH
+
+#include <cstdint>
+
+/// `Xoshiro256` is the xoshiro256** generator of D. Blackman and S. Vigna. It is several times
+/// faster than the standard engines and every bit of its output is usable, so one draw can feed
+/// many small random choices.
+class Xoshiro256
+{
+  private:
+    uint64_t _state[4];
+
+  public:
+    /// Seeds the state by expanding `seed` with splitmix64, as recommended by the authors.
+    explicit Xoshiro256(uint64_t seed = 0) noexcept
+    {
+        for (auto& word : _state)
+        {
+            seed += 0x9e3779b97f4a7c15;
+
+            uint64_t z { seed };
+            z    = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z    = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
+
+  public:
+    /// Returns the next 64 random bits.
+    uint64_t Next() noexcept
+    {
+        uint64_t const result { RotateLeft(_state[1] * 5, 7) * 9 };
+        uint64_t const t { _state[1] << 17 };
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = RotateLeft(_state[3], 45);
+
+        return result;
+    }
+
+  private:
+    static uint64_t RotateLeft(uint64_t x, int k) noexcept
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+#endif
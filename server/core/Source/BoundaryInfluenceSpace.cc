@@ -0,0 +1,246 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/BoundaryInfluenceSpace.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+constexpr float  defaultTolerance { 0.001f };
+constexpr size_t tileSize { 256 };
+constexpr float  dropThreshold { 1e-6f };
+constexpr float  quantizationLevels { 32767.0f };
+constexpr size_t maxInfluenceValues { size_t { 1 } << 26 };
+
+}
+
+BoundaryInfluenceSpace::BoundaryInfluenceSpace(uint16_t           width,
+                                               uint16_t           height,
+                                               SpaceConfig const& config) :
+    MatrixSpace { width, height, config },
+    _compressed { (config.flags & static_cast<uint32_t>(SpaceFlag::CompressInfluence)) != 0 },
+    _tolerance { config.tolerance > 0.0f ? config.tolerance : defaultTolerance },
+    _workers { config.numThreads },
+    _built { false },
+    _valid { false },
+    _numTiles { 0 },
+    _errorBound { 0.0f },
+    _solved { false }
+{}
+
+char const* BoundaryInfluenceSpace::GetName() noexcept
+{
+    return "Boundary Influence";
+}
+
+void BoundaryInfluenceSpace::SetThreadPolicy(ThreadPolicy const& policy) noexcept
+{
+    _workers.SetThreadPolicy(policy);
+}
+
+bool BoundaryInfluenceSpace::SolveEquation(SparseMatrix const&       A,
+                                           std::vector<float>&       x,
+                                           std::vector<float> const& b) noexcept
+try
+{
+    if (!_built || _influencePointTypes != pointTypes())
+        BuildInfluence(A);
+
+    if (!_valid)
+        return false;
+
+    size_t const numVars { x.size() };
+    if (numVars == 0)
+        return true;
+
+    // Collects the changed unknowns and bounds the error of applying them incrementally, which
+    // comes from the stored responses and from rounding the additions
+    bool  incremental { _solved };
+    float errorBound { _errorBound };
+    float maxB { 0.0f };
+    _changed.clear();
+    for (size_t i { 0 }; incremental && i < numVars; ++i)
+    {
+        maxB = std::max(maxB, std::abs(b[i]));
+        if (b[i] == _lastB[i])
+            continue;
+
+        if (_i2Column[i] < 0)
+        {
+            incremental = false;
+            break;
+        }
+
+        _changed.push_back(static_cast<uint32_t>(i));
+        errorBound += std::abs(b[i] - _lastB[i]) * _columnErrors[_i2Column[i]];
+    }
+    errorBound += _changed.size() * std::numeric_limits<float>::epsilon() * maxB;
+
+    // A solve costs about two passes over L, adding a response one pass over the field
+    size_t const solveCost { 2 * (_factorization.GetNumNonzeros() + numVars) };
+    incremental = incremental && errorBound <= _tolerance && _changed.size() * numVars <= solveCost;
+
+    if (incremental)
+    {
+        for (uint32_t i : _changed)
+        {
+            AddColumn(static_cast<size_t>(_i2Column[i]), b[i] - _lastB[i], x.data());
+            _lastB[i] = b[i];
+        }
+        _errorBound = errorBound;
+    }
+    else
+    {
+        _work.resize(numVars);
+        _factorization.Solve(b.data(), x.data(), _work.data());
+        _lastB.assign(b.begin(), b.end());
+        _errorBound = 0.0f;
+        _solved     = true;
+    }
+
+    return true;
+}
+catch (...)
+{
+    _built = false;
+    return false;
+}
+
+void BoundaryInfluenceSpace::BuildInfluence(SparseMatrix const& A)
+{
+    size_t const numVars { A.size() };
+
+    _built  = true;
+    _valid  = false;
+    _solved = false;
+    _influencePointTypes.assign(pointTypes().begin(), pointTypes().end());
+    _columns.clear();
+    _i2Column.assign(numVars, -1);
+    _changed.reserve(numVars);
+    _lastB.reserve(numVars);
+    _work.reserve(numVars);
+
+    GetNestedDissectionOrder(_order);
+    if (!_factorization.Factorize(A, _order))
+        return;
+
+    _valid = true;
+
+    for (auto& term : boundaryTerms())
+    {
+        if (_columns.empty() || _columns.back() != term.i)
+            _columns.push_back(term.i);
+    }
+
+    // Falls back to solving every update if the responses do not fit
+    if (_columns.size() * numVars > maxInfluenceValues)
+    {
+        _columns.clear();
+        return;
+    }
+
+    for (size_t column { 0 }; column < _columns.size(); ++column)
+        _i2Column[_columns[column]] = static_cast<int32_t>(column);
+
+    _numTiles = (numVars + tileSize - 1) / tileSize;
+    _tileScales.assign(_columns.size() * _numTiles, 0.0f);
+    _columnErrors.assign(_columns.size(), 0.0f);
+    if (_compressed)
+        _quantizedValues.assign(_columns.size() * numVars, 0);
+    else
+        _values.assign(_columns.size() * numVars, 0.0f);
+
+    _scratches.resize(_workers.GetNumThreads());
+    for (auto& scratch : _scratches)
+    {
+        scratch.rhs.assign(numVars, 0.0f);
+        scratch.response.resize(numVars);
+        scratch.work.resize(numVars);
+    }
+
+    _workers.ParallelFor(0, _columns.size(), [this](size_t column, uint32_t workerIdx) {
+        auto&          scratch { _scratches[workerIdx] };
+        uint32_t const i { _columns[column] };
+
+        scratch.rhs[i] = 1.0f;
+        _factorization.Solve(scratch.rhs.data(), scratch.response.data(), scratch.work.data());
+        scratch.rhs[i] = 0.0f;
+
+        StoreColumn(column, scratch.response);
+    });
+}
+
+void BoundaryInfluenceSpace::StoreColumn(size_t column, std::vector<float> const& response) noexcept
+{
+    size_t const numVars { response.size() };
+
+    float columnMax { 0.0f };
+    for (float value : response) columnMax = std::max(columnMax, std::abs(value));
+
+    float error { 0.0f };
+    for (size_t tile { 0 }; tile < _numTiles; ++tile)
+    {
+        size_t const begin { tile * tileSize };
+        size_t const end { std::min(numVars, begin + tileSize) };
+        size_t const offset { column * numVars };
+
+        float tileMax { 0.0f };
+        for (size_t i { begin }; i < end; ++i) tileMax = std::max(tileMax, std::abs(response[i]));
+
+        float& scale { _tileScales[column * _numTiles + tile] };
+        if (tileMax <= dropThreshold * columnMax)
+        {
+            scale = 0.0f;
+            error = std::max(error, tileMax);
+            continue;
+        }
+
+        if (_compressed)
+        {
+            scale = tileMax / quantizationLevels;
+            error = std::max(error, 0.5f * scale);
+            for (size_t i { begin }; i < end; ++i)
+            {
+                _quantizedValues[offset + i]
+                    = static_cast<int16_t>(std::lround(response[i] / scale));
+            }
+        }
+        else
+        {
+            scale = 1.0f;
+            std::copy(response.begin() + begin,
+                      response.begin() + end,
+                      _values.begin() + offset + begin);
+        }
+    }
+
+    _columnErrors[column] = error;
+}
+
+void BoundaryInfluenceSpace::AddColumn(size_t column, float delta, float* x) const noexcept
+{
+    size_t const numVars { _i2Column.size() };
+    size_t const offset { column * numVars };
+    for (size_t tile { 0 }; tile < _numTiles; ++tile)
+    {
+        float const scale { _tileScales[column * _numTiles + tile] };
+        if (scale == 0.0f)
+            continue;
+
+        size_t const begin { tile * tileSize };
+        size_t const end { std::min(numVars, begin + tileSize) };
+        if (_compressed)
+        {
+            float const factor { delta * scale };
+            for (size_t i { begin }; i < end; ++i) x[i] += factor * _quantizedValues[offset + i];
+        }
+        else
+        {
+            for (size_t i { begin }; i < end; ++i) x[i] += delta * _values[offset + i];
+        }
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/CholeskySpace.hh>
+
+#include <algorithm>
+
+namespace
+{
+
+constexpr size_t maxCachedFactorizations { 4 };
+
+}
+
+CholeskySpace::CholeskySpace(uint16_t width, uint16_t height, SpaceConfig const& config) :
+    MatrixSpace { width, height, config }
+{}
+
+char const* CholeskySpace::GetName() noexcept
+{
+    return "Cholesky";
+}
+
+bool CholeskySpace::SolveEquation(SparseMatrix const&       A,
+                                  std::vector<float>&       x,
+                                  std::vector<float> const& b) noexcept
+try
+{
+    if (x.empty())
+        return true;
+
+    CachedFactorization* cached { GetFactorization(A) };
+    if (!cached->valid)
+        return false;
+
+    _work.resize(x.size());
+    cached->factorization.Solve(b.data(), x.data(), _work.data());
+
+    return true;
+}
+catch (...)
+{
+    return false;
+}
+
+CholeskySpace::CachedFactorization* CholeskySpace::GetFactorization(SparseMatrix const& A)
+{
+    auto it { std::find_if(_factorizations.begin(), _factorizations.end(), [&](auto& cached) {
+        return cached.topologyHash == topologyHash() && cached.pointTypes == pointTypes();
+    }) };
+
+    // Keeps the most recently used factorization at the back
+    if (it != _factorizations.end())
+    {
+        std::rotate(it, it + 1, _factorizations.end());
+        return &_factorizations.back();
+    }
+
+    if (_factorizations.size() >= maxCachedFactorizations)
+        _factorizations.erase(_factorizations.begin());
+
+    GetNestedDissectionOrder(_order);
+
+    _factorizations.push_back(CachedFactorization { topologyHash(), pointTypes(), false, {} });
+
+    auto& cached { _factorizations.back() };
+    cached.valid = cached.factorization.Factorize(A, _order);
+
+    return &cached;
+}
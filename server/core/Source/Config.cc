@@ -3,12 +3,31 @@
 
 #include <leth/Lib.hh>
 #include <leth/Server.hh>
+#include <leth/SpaceRegistry.hh>
 
 // Spaces
+#include <leth/BoundaryInfluenceSpace.hh>
+#include <leth/CholeskySpace.hh>
+#include <leth/FastPoissonSpace.hh>
 #include <leth/FiniteElementMethodSpace.hh>
 #include <leth/MonteCarloSpace.hh>
 #include <leth/SuccessiveOverRelaxationSpace.hh>
 
+SpaceRegistry const& SpaceRegistry::GetDefault()
+{
+    static SpaceRegistry const registry { [] {
+        SpaceRegistry registry;
+        registry.Register<MonteCarloSpace>("MonteCarloSpace");
+        registry.Register<SuccessiveOverRelaxationSpace>("SuccessiveOverRelaxationSpace");
+        registry.Register<FiniteElementMethodSpace>("FiniteElementMethodSpace");
+        registry.Register<CholeskySpace>("CholeskySpace");
+        registry.Register<BoundaryInfluenceSpace>("BoundaryInfluenceSpace");
+        registry.Register<FastPoissonSpace>("FastPoissonSpace");
+        return registry;
+    }() };
+
+    return registry;
+}
 
 ServerHandle leth_create(uint16_t width, uint16_t height) noexcept
 try
@@ -20,3 +39,16 @@ catch (...)
 {
     return nullptr;
 }
+
+ServerHandle leth_create_ex(ServerConfig const* config) noexcept
+try
+{
+    if (config == nullptr)
+        return nullptr;
+
+    return Server::Make(*config, SpaceRegistry::GetDefault());
+}
+catch (...)
+{
+    return nullptr;
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/FastPoissonSpace.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+constexpr double pi { 3.14159265358979323846 };
+
+}
+
+FastPoissonSpace::FastPoissonSpace(uint16_t width, uint16_t height, SpaceConfig const& config) :
+    MatrixSpace { width, height, config },
+    _prepared { false },
+    _rectangular { false },
+    _numColumns { 0 },
+    _numRows { 0 },
+    _factorized { false }
+{}
+
+char const* FastPoissonSpace::GetName() noexcept
+{
+    return "Fast Poisson";
+}
+
+bool FastPoissonSpace::SolveEquation(SparseMatrix const&       A,
+                                     std::vector<float>&       x,
+                                     std::vector<float> const& b) noexcept
+try
+{
+    if (x.empty())
+        return true;
+
+    if (!_prepared || _preparedPointTypes != pointTypes())
+        Prepare(A);
+
+    if (_rectangular)
+    {
+        SolveRectangle(x, b);
+        return true;
+    }
+
+    if (!_factorized)
+        return false;
+
+    _work.resize(x.size());
+    _factorization.Solve(b.data(), x.data(), _work.data());
+
+    return true;
+}
+catch (...)
+{
+    _prepared = false;
+    return false;
+}
+
+void FastPoissonSpace::Prepare(SparseMatrix const& A)
+{
+    _prepared   = true;
+    _factorized = false;
+    _preparedPointTypes.assign(pointTypes().begin(), pointTypes().end());
+    _factorization.Clear();
+
+    _rectangular = IsRectangular(_numColumns, _numRows);
+    if (!_rectangular)
+    {
+        GetNestedDissectionOrder(_order);
+        _factorized = _factorization.Factorize(A, _order);
+        return;
+    }
+
+    size_t const m { _numColumns }, n { _numRows };
+
+    uint16_t minX { width() }, minY { height() };
+    for (auto& pos : positions())
+    {
+        minX = std::min(minX, pos.x);
+        minY = std::min(minY, pos.y);
+    }
+
+    _grid2I.resize(m * n);
+    for (size_t i { 0 }, iEnd { positions().size() }; i < iEnd; ++i)
+    {
+        Pos const& pos { positions()[i] };
+        _grid2I[(pos.y - minY) * m + (pos.x - minX)] = static_cast<uint32_t>(i);
+    }
+
+    if (_sineTransform.length() != m)
+        _sineTransform = SineTransform { m };
+
+    // Sine mode k turns the rows into a tridiagonal system with diagonal -4 + 2cos(πk / (m + 1))
+    // and ones beside it. Eliminating it from the top leaves the same pivots for every
+    // right-hand side, so their reciprocals are stored, one row of modes after another.
+    _pivots.resize(m * n);
+    for (size_t k { 0 }; k < m; ++k)
+    {
+        double const diagonal { -4.0 + 2.0 * std::cos(pi * static_cast<double>(k + 1) / (m + 1)) };
+        double       pivot { 1.0 / diagonal };
+        _pivots[k] = pivot;
+        for (size_t r { 1 }; r < n; ++r)
+        {
+            pivot              = 1.0 / (diagonal - pivot);
+            _pivots[r * m + k] = pivot;
+        }
+    }
+
+    _grid.resize(m * n);
+}
+
+void FastPoissonSpace::SolveRectangle(std::vector<float>& x, std::vector<float> const& b) noexcept
+{
+    size_t const m { _numColumns }, n { _numRows };
+    double*      grid { _grid.data() };
+
+    for (size_t idx { 0 }, idxEnd { m * n }; idx < idxEnd; ++idx) grid[idx] = b[_grid2I[idx]];
+
+    for (size_t r { 0 }; r < n; r += 2)
+        _sineTransform.Transform(grid + r * m, r + 1 < n ? grid + (r + 1) * m : nullptr);
+
+    // Solves the tridiagonal systems of all modes at once, row by row
+    for (size_t k { 0 }; k < m; ++k) grid[k] *= _pivots[k];
+    for (size_t r { 1 }; r < n; ++r)
+    {
+        double*       row { grid + r * m };
+        double const* above { row - m };
+        double const* pivots { _pivots.data() + r * m };
+        for (size_t k { 0 }; k < m; ++k) row[k] = (row[k] - above[k]) * pivots[k];
+    }
+    for (size_t r { n - 1 }; r-- > 0;)
+    {
+        double*       row { grid + r * m };
+        double const* below { row + m };
+        double const* pivots { _pivots.data() + r * m };
+        for (size_t k { 0 }; k < m; ++k) row[k] -= pivots[k] * below[k];
+    }
+
+    for (size_t r { 0 }; r < n; r += 2)
+        _sineTransform.Transform(grid + r * m, r + 1 < n ? grid + (r + 1) * m : nullptr);
+
+    // Transforming twice scales by (m + 1) / 2
+    double const scale { 2.0 / static_cast<double>(m + 1) };
+    for (size_t idx { 0 }, idxEnd { m * n }; idx < idxEnd; ++idx)
+        x[_grid2I[idx]] = static_cast<float>(grid[idx] * scale);
+}
@@ -0,0 +1,241 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/Fft.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+
+constexpr uint32_t maxRadix { 31 };
+constexpr double   pi { 3.14159265358979323846 };
+
+/// Multiplies complex numbers without the checks for infinities of `std::complex`, which are
+/// calls to the runtime unless the whole program is compiled for fast math
+inline Fft::Complex Multiply(Fft::Complex a, Fft::Complex b) noexcept
+{
+    return Fft::Complex { a.real() * b.real() - a.imag() * b.imag(),
+                          a.real() * b.imag() + a.imag() * b.real() };
+}
+
+inline Fft::Complex MultiplyByMinusI(Fft::Complex a) noexcept
+{
+    return Fft::Complex { a.imag(), -a.real() };
+}
+
+}
+
+Fft::Fft(size_t length) :
+    _length { length }
+{
+    if (length <= 1)
+        return;
+
+    // Splits off factors of 4 first, as they take the fewest operations per point
+    size_t rest { length };
+    while (rest % 4 == 0)
+    {
+        rest /= 4;
+        _stages.push_back(Stage { 4, rest });
+    }
+    for (uint32_t radix { 2 }; radix <= maxRadix && rest > 1; ++radix)
+    {
+        while (rest % radix == 0)
+        {
+            rest /= radix;
+            _stages.push_back(Stage { radix, rest });
+        }
+    }
+
+    if (rest == 1)
+    {
+        _twiddles.resize(length);
+        for (size_t k { 0 }; k < length; ++k)
+            _twiddles[k] = std::polar(1.0, -2.0 * pi * static_cast<double>(k) / length);
+        _buffer.resize(length);
+        return;
+    }
+
+    // With a large prime factor, jk = (j² + k² - (k - j)²) / 2 turns the transform into the
+    // convolution of the input and a chirp, which is computed by transforms of a power of two
+    _stages.clear();
+
+    size_t convolutionLength { 1 };
+    while (convolutionLength < 2 * length - 1) convolutionLength *= 2;
+    _convolution = std::make_unique<Fft>(convolutionLength);
+
+    _chirp.resize(length);
+    for (size_t j { 0 }; j < length; ++j)
+    {
+        uint64_t const square { static_cast<uint64_t>(j) * j % (2 * length) };
+        _chirp[j] = std::polar(1.0, -pi * static_cast<double>(square) / length);
+    }
+
+    _filter.assign(convolutionLength, Complex { 0.0, 0.0 });
+    _filter[0] = std::conj(_chirp[0]);
+    for (size_t j { 1 }; j < length; ++j)
+    {
+        _filter[j]                     = std::conj(_chirp[j]);
+        _filter[convolutionLength - j] = std::conj(_chirp[j]);
+    }
+    _convolution->Transform(_filter.data());
+    for (auto& value : _filter) value /= static_cast<double>(convolutionLength);
+
+    _buffer.resize(convolutionLength);
+}
+
+void Fft::Transform(Complex* data) noexcept
+{
+    if (_length <= 1)
+        return;
+
+    if (_convolution != nullptr)
+    {
+        TransformBluestein(data);
+        return;
+    }
+
+    std::copy(data, data + _length, _buffer.begin());
+    Work(data, _buffer.data(), 1, 0);
+}
+
+void Fft::Work(Complex* out, Complex const* in, size_t stride, size_t stage) noexcept
+{
+    uint32_t const radix { _stages[stage].radix };
+    size_t const   length { _stages[stage].length };
+
+    if (length == 1)
+    {
+        for (uint32_t q { 0 }; q < radix; ++q) out[q] = in[q * stride];
+    }
+    else
+    {
+        for (uint32_t q { 0 }; q < radix; ++q)
+            Work(out + q * length, in + q * stride, stride * radix, stage + 1);
+    }
+
+    Butterfly(out, stride, radix, length);
+}
+
+void Fft::Butterfly(Complex* out, size_t stride, uint32_t radix, size_t length) noexcept
+{
+    if (radix == 2)
+    {
+        for (size_t u { 0 }; u < length; ++u)
+        {
+            Complex const t { Multiply(out[u + length], _twiddles[u * stride]) };
+            out[u + length] = out[u] - t;
+            out[u] += t;
+        }
+        return;
+    }
+
+    if (radix == 3)
+    {
+        double const sine { std::sin(2.0 * pi / 3.0) };
+        for (size_t u { 0 }; u < length; ++u)
+        {
+            Complex const t0 { out[u] };
+            Complex const t1 { Multiply(out[u + length], _twiddles[u * stride]) };
+            Complex const t2 { Multiply(out[u + 2 * length], _twiddles[2 * u * stride]) };
+
+            Complex const sum { t1 + t2 };
+            Complex const middle { t0 - 0.5 * sum };
+            Complex const rotated { MultiplyByMinusI(sine * (t1 - t2)) };
+
+            out[u]              = t0 + sum;
+            out[u + length]     = middle + rotated;
+            out[u + 2 * length] = middle - rotated;
+        }
+        return;
+    }
+
+    if (radix == 4)
+    {
+        for (size_t u { 0 }; u < length; ++u)
+        {
+            Complex const t0 { out[u] };
+            Complex const t1 { Multiply(out[u + length], _twiddles[u * stride]) };
+            Complex const t2 { Multiply(out[u + 2 * length], _twiddles[2 * u * stride]) };
+            Complex const t3 { Multiply(out[u + 3 * length], _twiddles[3 * u * stride]) };
+
+            Complex const a { t0 + t2 }, b { t0 - t2 }, c { t1 + t3 };
+            Complex const d { MultiplyByMinusI(t1 - t3) };
+
+            out[u]              = a + c;
+            out[u + length]     = b + d;
+            out[u + 2 * length] = a - c;
+            out[u + 3 * length] = b - d;
+        }
+        return;
+    }
+
+    if (radix == 5)
+    {
+        double const cos1 { std::cos(2.0 * pi / 5.0) }, cos2 { std::cos(4.0 * pi / 5.0) };
+        double const sin1 { std::sin(2.0 * pi / 5.0) }, sin2 { std::sin(4.0 * pi / 5.0) };
+        for (size_t u { 0 }; u < length; ++u)
+        {
+            Complex const t0 { out[u] };
+            Complex const t1 { Multiply(out[u + length], _twiddles[u * stride]) };
+            Complex const t2 { Multiply(out[u + 2 * length], _twiddles[2 * u * stride]) };
+            Complex const t3 { Multiply(out[u + 3 * length], _twiddles[3 * u * stride]) };
+            Complex const t4 { Multiply(out[u + 4 * length], _twiddles[4 * u * stride]) };
+
+            Complex const sum1 { t1 + t4 }, difference1 { t1 - t4 };
+            Complex const sum2 { t2 + t3 }, difference2 { t2 - t3 };
+
+            Complex const middle1 { t0 + cos1 * sum1 + cos2 * sum2 };
+            Complex const middle2 { t0 + cos2 * sum1 + cos1 * sum2 };
+            Complex const rotated1 { MultiplyByMinusI(sin1 * difference1 + sin2 * difference2) };
+            Complex const rotated2 { MultiplyByMinusI(sin2 * difference1 - sin1 * difference2) };
+
+            out[u]              = t0 + sum1 + sum2;
+            out[u + length]     = middle1 + rotated1;
+            out[u + 2 * length] = middle2 + rotated2;
+            out[u + 3 * length] = middle2 - rotated2;
+            out[u + 4 * length] = middle1 - rotated1;
+        }
+        return;
+    }
+
+    // Computes every output of a `radix`-point transform, folding in the twiddle factors
+    std::array<Complex, maxRadix> scratch;
+    for (size_t u { 0 }; u < length; ++u)
+    {
+        for (uint32_t q { 0 }; q < radix; ++q) scratch[q] = out[u + q * length];
+
+        for (uint32_t s { 0 }; s < radix; ++s)
+        {
+            size_t const k { u + s * length };
+            size_t       twiddle { 0 };
+            Complex      sum { scratch[0] };
+            for (uint32_t q { 1 }; q < radix; ++q)
+            {
+                twiddle += stride * k;
+                if (twiddle >= _length)
+                    twiddle -= _length;
+
+                sum += Multiply(scratch[q], _twiddles[twiddle]);
+            }
+            out[k] = sum;
+        }
+    }
+}
+
+void Fft::TransformBluestein(Complex* data) noexcept
+{
+    std::fill(_buffer.begin(), _buffer.end(), Complex { 0.0, 0.0 });
+    for (size_t j { 0 }; j < _length; ++j) _buffer[j] = Multiply(data[j], _chirp[j]);
+
+    // The inverse transform is the conjugate of the transform of the conjugate
+    _convolution->Transform(_buffer.data());
+    for (size_t j { 0 }, jEnd { _buffer.size() }; j < jEnd; ++j)
+        _buffer[j] = std::conj(Multiply(_buffer[j], _filter[j]));
+    _convolution->Transform(_buffer.data());
+
+    for (size_t k { 0 }; k < _length; ++k) data[k] = Multiply(std::conj(_buffer[k]), _chirp[k]);
+}
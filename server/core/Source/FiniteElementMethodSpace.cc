@@ -3,7 +3,9 @@
 
 #include <leth/FiniteElementMethodSpace.hh>
 
-FiniteElementMethodSpace::FiniteElementMethodSpace(uint16_t width, uint16_t height) :
+FiniteElementMethodSpace::FiniteElementMethodSpace(uint16_t width,
+                                                   uint16_t height,
+                                                   SpaceConfig const& /*config*/) :
     Space { width, height }
 {}
 
@@ -0,0 +1,630 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/Journal.hh>
+
+#include <cstring>
+#include <utility>
+
+namespace
+{
+
+constexpr char     fileMagic[8] { 'L', 'E', 'T', 'H', 'J', 'R', 'N', 'L' };
+constexpr uint16_t fileVersion { 1 };
+constexpr size_t   fileHeaderSize { 28 };
+constexpr size_t   blockHeaderSize { 8 };
+constexpr size_t   maxBlockSize { 1 << 30 };
+
+void PutU16(uint8_t* out, uint16_t value) noexcept
+{
+    for (int i { 0 }; i < 2; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void PutU32(uint8_t* out, uint32_t value) noexcept
+{
+    for (int i { 0 }; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void PutU64(uint8_t* out, uint64_t value) noexcept
+{
+    for (int i { 0 }; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint64_t GetLittleEndian(uint8_t const* in, int numBytes) noexcept
+{
+    uint64_t value { 0 };
+    for (int i { 0 }; i < numBytes; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutSignedVarint(std::vector<uint8_t>& out, int64_t value)
+{
+    PutVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+bool GetVarint(std::vector<uint8_t> const& in, size_t& offset, uint64_t& value) noexcept
+{
+    value = 0;
+    for (int shift { 0 }; shift < 64; shift += 7)
+    {
+        if (offset >= in.size())
+            return false;
+
+        uint8_t const byte { in[offset++] };
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool GetSignedVarint(std::vector<uint8_t> const& in, size_t& offset, int64_t& value) noexcept
+{
+    uint64_t raw;
+    if (!GetVarint(in, offset, raw))
+        return false;
+
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+uint32_t ToBits(float value) noexcept
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float FromBits(uint32_t bits) noexcept
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// Packs the XOR of two temperatures into an integer whose magnitude depends on the number of
+/// significant bits only. The low 5 bits hold the number of trailing zeros.
+uint64_t PackXor(uint32_t xorValue) noexcept
+{
+    if (xorValue == 0)
+        return 0;
+
+    uint32_t numTrailingZeros { 0 };
+    while ((xorValue & 1) == 0)
+    {
+        xorValue >>= 1;
+        ++numTrailingZeros;
+    }
+    return (static_cast<uint64_t>(xorValue) << 5) | numTrailingZeros;
+}
+
+uint32_t UnpackXor(uint64_t packed) noexcept
+{
+    if (packed == 0)
+        return 0;
+
+    return static_cast<uint32_t>((packed >> 5) << (packed & 31));
+}
+
+}
+
+#pragma region Journal
+
+Journal::Journal(uint16_t width, uint16_t height, SpaceIndex numSpaces) :
+    _width { width },
+    _height { height },
+    _numSpaces { numSpaces },
+    _active { false },
+    _ring(RingCapacity),
+    _ringHead { 0 },
+    _ringTail { 0 },
+    _numDropped { 0 },
+    _numDroppedTotal { 0 },
+    _checkpointSlots(numSpaces),
+    _checkpointInterval { 0 },
+    _maxFileSize { 0 },
+    _fileIndex { 0 },
+    _file { nullptr },
+    _fileSize { 0 }
+{}
+
+Journal::~Journal() noexcept
+{
+    Stop();
+}
+
+bool Journal::Start(char const* path, uint64_t maxFileSize, uint32_t checkpointIntervalMs) noexcept
+try
+{
+    std::lock_guard<std::mutex> guard { _controlLock };
+    if (IsActive())
+        return false;
+
+    _path               = path;
+    _maxFileSize        = maxFileSize;
+    _fileIndex          = 0;
+    _startTime          = std::chrono::steady_clock::now();
+    _checkpointInterval = checkpointIntervalMs == 0
+                              ? -1
+                              : static_cast<int64_t>(checkpointIntervalMs) * 1000000;
+    for (auto& slot : _checkpointSlots) slot.lastTime = -_checkpointInterval;
+
+    if (!OpenNextFile())
+        return false;
+
+    _ringTail.store(_ringHead.load(std::memory_order_acquire), std::memory_order_release);
+    _numDropped      = 0;
+    _numDroppedTotal = 0;
+    _active.store(true, std::memory_order_release);
+    _writerThread = std::thread { &Journal::WriteRecords, this };
+
+    return true;
+}
+catch (...)
+{
+    _active = false;
+    CloseFile();
+    return false;
+}
+
+void Journal::Stop() noexcept
+{
+    std::lock_guard<std::mutex> guard { _controlLock };
+    if (!_writerThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> wakeGuard { _wakeLock };
+        _active.store(false, std::memory_order_release);
+    }
+    _wake.notify_one();
+    _writerThread.join();
+}
+
+int64_t Journal::Now() const noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+                                                                - _startTime)
+        .count();
+}
+
+void Journal::RecordSetPoint(uint16_t x, uint16_t y, float temp, PointType type) noexcept
+{
+    if (!IsActive())
+        return;
+
+    size_t const head { _ringHead.load(std::memory_order_relaxed) };
+    if (head - _ringTail.load(std::memory_order_acquire) >= RingCapacity)
+    {
+        _numDropped.fetch_add(1, std::memory_order_relaxed);
+        _numDroppedTotal.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    _ring[head & (RingCapacity - 1)] = SetPointEntry { Now(), x, y, temp, type };
+    _ringHead.store(head + 1, std::memory_order_release);
+}
+
+void Journal::RecordCheckpoint(SpaceIndex spaceIdx, ErrorCode errorCode, float const* temp) noexcept
+try
+{
+    if (!IsActive() || _checkpointInterval < 0 || spaceIdx >= _checkpointSlots.size())
+        return;
+
+    auto&         slot { _checkpointSlots[spaceIdx] };
+    int64_t const now { Now() };
+    if (now - slot.lastTime.load(std::memory_order_relaxed) < _checkpointInterval)
+        return;
+
+    std::unique_lock<std::mutex> lock { slot.lock, std::try_to_lock };
+    if (!lock.owns_lock())
+        return;
+
+    slot.temp.assign(temp, temp + static_cast<size_t>(_width) * _height);
+    slot.time      = now;
+    slot.errorCode = errorCode;
+    slot.pending   = true;
+    slot.lastTime.store(now, std::memory_order_relaxed);
+}
+catch (...)
+{}
+
+void Journal::WriteRecords() noexcept
+try
+{
+    std::vector<uint8_t> block;
+    std::vector<float>   checkpoint;
+    while (true)
+    {
+        bool const active { IsActive() };
+
+        // Retries creating the file a previous rotation or write failed to create. The file must
+        // be opened before encoding, which resets the encoder.
+        if (_file == nullptr)
+            OpenNextFile();
+
+        block.resize(blockHeaderSize);
+        uint32_t numRecords { 0 };
+
+        uint64_t const numDropped { _numDropped.exchange(0, std::memory_order_relaxed) };
+        if (numDropped != 0)
+        {
+            EncodeDropped(block, Now(), numDropped);
+            ++numRecords;
+        }
+
+        size_t       tail { _ringTail.load(std::memory_order_relaxed) };
+        size_t const head { _ringHead.load(std::memory_order_acquire) };
+        for (; tail != head; ++tail)
+        {
+            EncodeSetPoint(block, _ring[tail & (RingCapacity - 1)]);
+            ++numRecords;
+        }
+        _ringTail.store(tail, std::memory_order_release);
+
+        for (SpaceIndex spaceIdx { 0 }; spaceIdx < _numSpaces; ++spaceIdx)
+        {
+            auto&     slot { _checkpointSlots[spaceIdx] };
+            int64_t   time;
+            ErrorCode errorCode;
+            {
+                std::lock_guard<std::mutex> guard { slot.lock };
+                if (!slot.pending)
+                    continue;
+
+                std::swap(slot.temp, checkpoint);
+                time         = slot.time;
+                errorCode    = slot.errorCode;
+                slot.pending = false;
+            }
+            EncodeCheckpoint(block, spaceIdx, time, errorCode, checkpoint);
+            ++numRecords;
+        }
+
+        if (numRecords != 0)
+        {
+            PutU32(block.data(), static_cast<uint32_t>(block.size() - blockHeaderSize));
+            PutU32(block.data() + 4, numRecords);
+            if (_file != nullptr
+                && std::fwrite(block.data(), 1, block.size(), _file) == block.size()
+                && std::fflush(_file) == 0)
+            {
+                _fileSize += block.size();
+                if (_maxFileSize != 0 && _fileSize >= _maxFileSize)
+                {
+                    CloseFile();
+                    OpenNextFile();
+                }
+            }
+            else
+            {
+                // A partially written block cannot be decoded, so the file is abandoned. The
+                // records are reported by the first block of the next file.
+                CloseFile();
+                uint64_t const numLost { numRecords - (numDropped != 0 ? 1 : 0) };
+                _numDropped.fetch_add(numDropped + numLost, std::memory_order_relaxed);
+                _numDroppedTotal.fetch_add(numLost, std::memory_order_relaxed);
+            }
+        }
+
+        if (!active)
+            break;
+
+        std::unique_lock<std::mutex> lock { _wakeLock };
+        _wake.wait_for(lock, std::chrono::milliseconds { 10 }, [this] { return !IsActive(); });
+    }
+
+    CloseFile();
+}
+catch (...)
+{
+    CloseFile();
+}
+
+bool Journal::OpenNextFile() noexcept
+try
+{
+    std::string const fileName { _path + "." + std::to_string(_fileIndex) };
+    _file = std::fopen(fileName.c_str(), "wb");
+    if (_file == nullptr)
+        return false;
+
+    ++_fileIndex;
+
+    size_t const length { static_cast<size_t>(_width) * _height };
+    _encoder.time = 0;
+    _encoder.x    = 0;
+    _encoder.y    = 0;
+    _encoder.temp.assign(length, 0);
+    _encoder.checkpoints.resize(_numSpaces);
+    for (auto& checkpoint : _encoder.checkpoints) checkpoint.assign(length, 0.0f);
+
+    int64_t const wallTime {
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+            - std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::steady_clock::now() - _startTime))
+            .count(),
+    };
+
+    uint8_t header[fileHeaderSize] {};
+    std::memcpy(header, fileMagic, sizeof(fileMagic));
+    PutU16(header + 8, fileVersion);
+    PutU16(header + 10, _width);
+    PutU16(header + 12, _height);
+    PutU32(header + 16, _numSpaces);
+    PutU64(header + 20, static_cast<uint64_t>(wallTime));
+    if (std::fwrite(header, 1, sizeof(header), _file) != sizeof(header))
+    {
+        CloseFile();
+        return false;
+    }
+    _fileSize = sizeof(header);
+
+    return true;
+}
+catch (...)
+{
+    CloseFile();
+    return false;
+}
+
+void Journal::CloseFile() noexcept
+{
+    if (_file == nullptr)
+        return;
+
+    std::fclose(_file);
+    _file = nullptr;
+}
+
+void Journal::EncodeSetPoint(std::vector<uint8_t>& out, SetPointEntry const& entry)
+{
+    size_t const idx { static_cast<size_t>(entry.y) * _width + entry.x };
+    uint32_t     bits { ToBits(entry.temp) };
+
+    out.push_back(static_cast<uint8_t>(JournalRecordType::SetPoint)
+                  | (static_cast<uint8_t>(entry.type) << 2));
+    PutSignedVarint(out, entry.time - _encoder.time);
+    PutSignedVarint(out, static_cast<int64_t>(entry.x) - _encoder.x);
+    PutSignedVarint(out, static_cast<int64_t>(entry.y) - _encoder.y);
+    PutVarint(out, PackXor(bits ^ _encoder.temp[idx]));
+
+    _encoder.time      = entry.time;
+    _encoder.x         = entry.x;
+    _encoder.y         = entry.y;
+    _encoder.temp[idx] = bits;
+}
+
+void Journal::EncodeCheckpoint(std::vector<uint8_t>&     out,
+                               SpaceIndex                spaceIdx,
+                               int64_t                   time,
+                               ErrorCode                 errorCode,
+                               std::vector<float> const& temp)
+{
+    auto& previous { _encoder.checkpoints[spaceIdx] };
+
+    out.push_back(static_cast<uint8_t>(JournalRecordType::Checkpoint));
+    PutSignedVarint(out, time - _encoder.time);
+    PutVarint(out, spaceIdx);
+    PutVarint(out, errorCode);
+
+    uint64_t numUnchanged { 0 };
+    for (size_t i { 0 }, length { previous.size() }; i < length; ++i)
+    {
+        uint32_t const xorValue { ToBits(temp[i]) ^ ToBits(previous[i]) };
+        if (xorValue == 0)
+        {
+            ++numUnchanged;
+            continue;
+        }
+
+        PutVarint(out, numUnchanged);
+        PutVarint(out, PackXor(xorValue));
+        numUnchanged = 0;
+    }
+    if (numUnchanged != 0)
+        PutVarint(out, numUnchanged);
+
+    _encoder.time = time;
+    previous      = temp;
+}
+
+void Journal::EncodeDropped(std::vector<uint8_t>& out, int64_t time, uint64_t numDropped)
+{
+    out.push_back(static_cast<uint8_t>(JournalRecordType::Dropped));
+    PutSignedVarint(out, time - _encoder.time);
+    PutVarint(out, numDropped);
+
+    _encoder.time = time;
+}
+
+#pragma endregion Journal
+
+#pragma region JournalReader
+
+JournalReader::JournalReader() :
+    _file { nullptr },
+    _width { 0 },
+    _height { 0 },
+    _numSpaces { 0 },
+    _startTime { 0 },
+    _blockOffset { 0 },
+    _blockRecordsLeft { 0 },
+    _time { 0 },
+    _x { 0 },
+    _y { 0 }
+{}
+
+JournalReader::~JournalReader() noexcept
+{
+    if (_file != nullptr)
+        std::fclose(_file);
+}
+
+bool JournalReader::Open(char const* path) noexcept
+try
+{
+    if (_file != nullptr)
+        std::fclose(_file);
+
+    _file = std::fopen(path, "rb");
+    if (_file == nullptr)
+        return false;
+
+    uint8_t header[fileHeaderSize];
+    if (std::fread(header, 1, sizeof(header), _file) != sizeof(header)
+        || std::memcmp(header, fileMagic, sizeof(fileMagic)) != 0
+        || GetLittleEndian(header + 8, 2) != fileVersion)
+    {
+        std::fclose(_file);
+        _file = nullptr;
+        return false;
+    }
+
+    _width     = static_cast<uint16_t>(GetLittleEndian(header + 10, 2));
+    _height    = static_cast<uint16_t>(GetLittleEndian(header + 12, 2));
+    _numSpaces = static_cast<SpaceIndex>(GetLittleEndian(header + 16, 4));
+    _startTime = static_cast<int64_t>(GetLittleEndian(header + 20, 8));
+
+    size_t const length { static_cast<size_t>(_width) * _height };
+    _block.clear();
+    _blockOffset      = 0;
+    _blockRecordsLeft = 0;
+    _time             = 0;
+    _x                = 0;
+    _y                = 0;
+    _temp.assign(length, 0);
+    _checkpoints.assign(_numSpaces, std::vector<float>(length, 0.0f));
+
+    return true;
+}
+catch (...)
+{
+    return false;
+}
+
+bool JournalReader::ReadBlock() noexcept
+try
+{
+    uint8_t header[blockHeaderSize];
+    if (_file == nullptr || std::fread(header, 1, sizeof(header), _file) != sizeof(header))
+        return false;
+
+    size_t const blockSize { static_cast<size_t>(GetLittleEndian(header, 4)) };
+    if (blockSize > maxBlockSize)
+        return false;
+
+    _block.resize(blockSize);
+    if (std::fread(_block.data(), 1, blockSize, _file) != blockSize)
+        return false;
+
+    _blockOffset      = 0;
+    _blockRecordsLeft = static_cast<uint32_t>(GetLittleEndian(header + 4, 4));
+    return true;
+}
+catch (...)
+{
+    return false;
+}
+
+bool JournalReader::Next(JournalRecord& record) noexcept
+try
+{
+    while (_blockRecordsLeft == 0)
+    {
+        if (!ReadBlock())
+            return false;
+    }
+    --_blockRecordsLeft;
+
+    if (_blockOffset >= _block.size())
+        return false;
+
+    uint8_t const tag { _block[_blockOffset++] };
+    int64_t       timeDelta;
+    if (!GetSignedVarint(_block, _blockOffset, timeDelta))
+        return false;
+
+    _time       = _time + timeDelta;
+    record.type = static_cast<JournalRecordType>(tag & 3);
+    record.time = _time;
+
+    switch (record.type)
+    {
+    case JournalRecordType::SetPoint:
+    {
+        int64_t  dx, dy;
+        uint64_t packed;
+        if (!GetSignedVarint(_block, _blockOffset, dx) || !GetSignedVarint(_block, _blockOffset, dy)
+            || !GetVarint(_block, _blockOffset, packed))
+            return false;
+
+        _x = static_cast<uint16_t>(_x + dx);
+        _y = static_cast<uint16_t>(_y + dy);
+        if (_x >= _width || _y >= _height)
+            return false;
+
+        size_t const idx { static_cast<size_t>(_y) * _width + _x };
+        _temp[idx] ^= UnpackXor(packed);
+
+        record.x         = _x;
+        record.y         = _y;
+        record.temp      = FromBits(_temp[idx]);
+        record.pointType = static_cast<PointType>((tag >> 2) & 3);
+        return true;
+    }
+    case JournalRecordType::Checkpoint:
+    {
+        uint64_t spaceIdx, errorCode;
+        if (!GetVarint(_block, _blockOffset, spaceIdx)
+            || !GetVarint(_block, _blockOffset, errorCode) || spaceIdx >= _numSpaces)
+            return false;
+
+        auto& previous { _checkpoints[spaceIdx] };
+        for (size_t i { 0 }, length { previous.size() }; i < length;)
+        {
+            uint64_t numUnchanged, packed;
+            if (!GetVarint(_block, _blockOffset, numUnchanged) || numUnchanged > length - i)
+                return false;
+
+            i += numUnchanged;
+            if (i == length)
+                break;
+
+            if (!GetVarint(_block, _blockOffset, packed))
+                return false;
+
+            previous[i] = FromBits(ToBits(previous[i]) ^ UnpackXor(packed));
+            ++i;
+        }
+
+        record.spaceIdx  = static_cast<SpaceIndex>(spaceIdx);
+        record.errorCode = static_cast<ErrorCode>(errorCode);
+        record.result    = previous;
+        return true;
+    }
+    case JournalRecordType::Dropped:
+    {
+        return GetVarint(_block, _blockOffset, record.numDropped);
+    }
+    }
+
+    return false;
+}
+catch (...)
+{
+    return false;
+}
+
+#pragma endregion JournalReader
@@ -2,18 +2,76 @@
 // Licensed under the MIT License.
 
 #include <leth/MatrixSpace.hh>
+#include <leth/SparseCholesky.hh>
+#include <leth/WorkerPool.hh>
 
+#include <algorithm>
 #include <limits>
-#include <random>
+#include <thread>
 
-MatrixSpace::MatrixSpace(uint16_t width, uint16_t height) :
+namespace
+{
+
+constexpr ptrdiff_t maxLeafSize { 8 };
+
+/// Number of right-hand sides of a batch solved together, filling two cache lines of each row of
+/// the interleaved solutions
+constexpr size_t batchBlockSize { 16 };
+
+/// Orders the unknowns in `[begin, end)` by nested dissection: the unknowns are split by a line
+/// of the grid across the longer side of their bounding box, both halves are ordered recursively
+/// and the line is eliminated last. The halves are not adjacent in the five-point stencil, so
+/// eliminating one never fills the other.
+void Dissect(std::vector<Pos> const& positions, uint32_t* begin, uint32_t* end) noexcept
+{
+    if (end - begin <= maxLeafSize)
+        return;
+
+    uint16_t minX { positions[*begin].x }, maxX { minX };
+    uint16_t minY { positions[*begin].y }, maxY { minY };
+    for (uint32_t* it { begin }; it != end; ++it)
+    {
+        minX = std::min(minX, positions[*it].x);
+        maxX = std::max(maxX, positions[*it].x);
+        minY = std::min(minY, positions[*it].y);
+        maxY = std::max(maxY, positions[*it].y);
+    }
+
+    bool const     alongX { maxX - minX >= maxY - minY };
+    uint16_t const middle { static_cast<uint16_t>(alongX ? (minX + maxX) / 2 : (minY + maxY) / 2) };
+    auto const     getCoord { [&](uint32_t i) {
+        return alongX ? positions[i].x : positions[i].y;
+    } };
+
+    uint32_t* const separator { std::partition(begin, end, [&](uint32_t i) {
+        return getCoord(i) != middle;
+    }) };
+    uint32_t* const upper { std::partition(begin, separator, [&](uint32_t i) {
+        return getCoord(i) < middle;
+    }) };
+
+    Dissect(positions, begin, upper);
+    Dissect(positions, upper, separator);
+}
+
+}
+
+MatrixSpace::MatrixSpace(uint16_t width, uint16_t height, SpaceConfig const& /*config*/) :
     Space { width, height },
-    _pos2I(static_cast<size_t>(width) * height, std::numeric_limits<size_t>::max())
+    _pos2I(static_cast<size_t>(width) * height, std::numeric_limits<size_t>::max()),
+    _topologyHash { 0 },
+    _numColumns { 0 },
+    _numRows { 0 }
 {
-    _A.reserve(static_cast<size_t>(width) * width * height * height);
-    _x.reserve(static_cast<size_t>(width) * height);
-    _b.reserve(static_cast<size_t>(width) * height);
-    _i2Pos.reserve(static_cast<size_t>(width) * height);
+    size_t const numPoints { static_cast<size_t>(width) * height };
+    _A.diagonal.reserve(numPoints);
+    _A.rowStarts.reserve(numPoints + 1);
+    _A.columns.reserve(4 * numPoints);
+    _A.values.reserve(4 * numPoints);
+    _x.reserve(numPoints);
+    _b.reserve(numPoints);
+    _i2Pos.reserve(numPoints);
+    _pointTypes.reserve(numPoints);
 }
 
 char const* MatrixSpace::GetName() noexcept
@@ -32,6 +90,7 @@ char const* MatrixSpace::GetErrorMessageInternal(ErrorType errorType) noexcept
     {
     case ErrorType::Success: return "Success";
     case ErrorType::InvalidEquation: return "Insufficient boundary condition";
+    case ErrorType::OutOfMemory: return "Out of memory";
     }
 
     return "Unknown error";
@@ -45,22 +104,167 @@ ErrorCode MatrixSpace::RunSimulation(Point const* input, float* output) noexcept
 MatrixSpace::ErrorType MatrixSpace::RunSimulationInternal(Point const* input,
                                                           float*       output) noexcept
 {
-    if (!BuildEquation(input))
+    if (!IsSameTopology(input))
+    {
+        BuildMatrix(input);
+        GuessSolution(input, output, _x);
+    }
+
+    BuildRightHandSide(input);
+    if (!SolveEquation(_A, _x, _b))
+    {
+        // Starts over from zeros instead of a diverged solution
+        std::fill(_x.begin(), _x.end(), 0.0f);
         return ErrorType::InvalidEquation;
+    }
 
-    SolveEquation(_A, _x, _b);
     CopyResults(input, output);
 
     return ErrorType::Success;
 }
 
-bool MatrixSpace::BuildEquation(Point const* input) noexcept
+ErrorCode MatrixSpace::SolveBatch(PointType const*    type,
+                                  float const*        temps,
+                                  size_t              numScenarios,
+                                  float*              results,
+                                  uint32_t            numThreads,
+                                  ThreadPolicy const& policy) noexcept
+try
+{
+    return static_cast<ErrorCode>(
+        SolveBatchInternal(type, temps, numScenarios, results, numThreads, policy));
+}
+catch (...)
+{
+    return static_cast<ErrorCode>(ErrorType::OutOfMemory);
+}
+
+MatrixSpace::ErrorType MatrixSpace::SolveBatchInternal(PointType const*    type,
+                                                       float const*        temps,
+                                                       size_t              numScenarios,
+                                                       float*              results,
+                                                       uint32_t            numThreads,
+                                                       ThreadPolicy const& policy)
+{
+    size_t const numPoints { static_cast<size_t>(width()) * height() };
+
+    std::vector<Point> input(numPoints);
+    for (size_t idx { 0 }; idx < numPoints; ++idx) input[idx] = Point { type[idx], 0.0f };
+
+    SparseMatrix              A;
+    std::vector<Pos>          i2Pos;
+    std::vector<size_t>       pos2I(numPoints);
+    std::vector<BoundaryTerm> boundaryTerms;
+    Assemble(input.data(), A, i2Pos, pos2I, boundaryTerms);
+
+    size_t const          numVars { i2Pos.size() };
+    std::vector<uint32_t> order(numVars);
+    for (size_t i { 0 }; i < numVars; ++i) order[i] = static_cast<uint32_t>(i);
+    Dissect(i2Pos, order.data(), order.data() + numVars);
+
+    SparseCholesky factorization;
+    if (numVars != 0 && !factorization.Factorize(A, order))
+        return ErrorType::InvalidEquation;
+
+    size_t const   numBlocks { (numScenarios + batchBlockSize - 1) / batchBlockSize };
+    uint32_t const numWorkers { static_cast<uint32_t>(std::min<size_t>(
+        numThreads != 0 ? numThreads : std::max(std::thread::hardware_concurrency(), 1u),
+        std::max<size_t>(numBlocks, 1))) };
+
+    WorkerPool workers { numWorkers };
+    workers.SetThreadPolicy(policy);
+
+    std::vector<float>  rhs(numWorkers * batchBlockSize * numVars);
+    std::vector<double> work(numWorkers * batchBlockSize * numVars);
+
+    workers.ParallelFor(0, numBlocks, [&](size_t block, uint32_t workerIdx) {
+        size_t const first { block * batchBlockSize };
+        size_t const count { std::min(batchBlockSize, numScenarios - first) };
+        float* const b { rhs.data() + workerIdx * batchBlockSize * numVars };
+
+        std::fill(b, b + count * numVars, 0.0f);
+        for (size_t r { 0 }; r < count; ++r)
+        {
+            float const* temp { temps + (first + r) * numPoints };
+            for (auto& term : boundaryTerms) b[r * numVars + term.i] -= temp[term.inputIdx];
+        }
+
+        factorization.Solve(b, b, count, work.data() + workerIdx * batchBlockSize * numVars);
+
+        for (size_t r { 0 }; r < count; ++r)
+        {
+            float const* temp { temps + (first + r) * numPoints };
+            float*       output { results + (first + r) * numPoints };
+            for (size_t idx { 0 }; idx < numPoints; ++idx)
+                output[idx] = type[idx] == PointType::Boundary ? temp[idx] : 0.0f;
+            for (size_t i { 0 }; i < numVars; ++i)
+                output[GetIndex(i2Pos[i].y, i2Pos[i].x)] = b[r * numVars + i];
+        }
+    });
+
+    return ErrorType::Success;
+}
+
+bool MatrixSpace::IsSameTopology(Point const* input) const noexcept
+{
+    size_t const numPoints { static_cast<size_t>(width()) * height() };
+    if (_pointTypes.size() != numPoints)
+        return false;
+
+    for (size_t i { 0 }; i < numPoints; ++i)
+    {
+        if (_pointTypes[i] != input[i].type)
+            return false;
+    }
+
+    return true;
+}
+
+void MatrixSpace::BuildMatrix(Point const* input) noexcept
+{
+    _pointTypes.clear();
+    for (size_t i { 0 }, iEnd { static_cast<size_t>(width()) * height() }; i < iEnd; ++i)
+        _pointTypes.push_back(input[i].type);
+
+    bool const   hasWalls { Assemble(input, _A, _i2Pos, _pos2I, _boundaryTerms) };
+    size_t const numVars { _i2Pos.size() };
+
+    _x.assign(numVars, 0.0f);
+    _b.assign(numVars, 0.0f);
+    _topologyHash = GetTopologyHash(input);
+    _numColumns   = 0;
+    _numRows      = 0;
+
+    if (numVars != 0 && !hasWalls)
+    {
+        uint16_t minX { width() }, maxX { 0 }, minY { height() }, maxY { 0 };
+        for (auto& pos : _i2Pos)
+        {
+            minX = std::min(minX, pos.x);
+            maxX = std::max(maxX, pos.x);
+            minY = std::min(minY, pos.y);
+            maxY = std::max(maxY, pos.y);
+        }
+
+        uint32_t const numColumns { static_cast<uint32_t>(maxX - minX + 1) };
+        uint32_t const numRows { static_cast<uint32_t>(maxY - minY + 1) };
+        if (static_cast<size_t>(numColumns) * numRows == numVars)
+        {
+            _numColumns = numColumns;
+            _numRows    = numRows;
+        }
+    }
+}
+
+bool MatrixSpace::Assemble(Point const*               input,
+                           SparseMatrix&              A,
+                           std::vector<Pos>&          i2Pos,
+                           std::vector<size_t>&       pos2I,
+                           std::vector<BoundaryTerm>& boundaryTerms) const
 {
-    _A.clear();
-    _x.clear();
-    _b.clear();
-    _i2Pos.clear();
-    _i2NumNeighboringWalls.clear();
+    A.Clear();
+    i2Pos.clear();
+    boundaryTerms.clear();
 
     constexpr int16_t offsets[4][2] {
         { -1, 0 },
@@ -76,67 +280,75 @@ bool MatrixSpace::BuildEquation(Point const* input) noexcept
             size_t const idx { GetIndex(i, j) };
             if (input[idx].type == PointType::GroundTruth)
             {
-                uint32_t numNeighboringWalls { 0 };
-                for (auto& offset : offsets)
-                {
-                    if (!Inside(i + offset[0], j + offset[1]))
-                    {
-                        ++numNeighboringWalls;
-                        continue;
-                    }
-
-                    if (input[GetIndex(i + offset[0], j + offset[1])].type == PointType::OutOfRange)
-                    {
-                        ++numNeighboringWalls;
-                        continue;
-                    }
-                }
-
-                _pos2I[idx] = _i2Pos.size();
-                _i2NumNeighboringWalls.push_back(numNeighboringWalls);
-                _i2Pos.push_back(Pos { static_cast<uint16_t>(j), static_cast<uint16_t>(i) });
+                pos2I[idx] = i2Pos.size();
+                i2Pos.push_back(Pos { static_cast<uint16_t>(j), static_cast<uint16_t>(i) });
             }
             else
-                _pos2I[idx] = std::numeric_limits<size_t>::max();
+                pos2I[idx] = std::numeric_limits<size_t>::max();
         }
     }
 
-    size_t const numVars { _i2Pos.size() };
-    _A.resize(numVars * numVars, 0.0f);
-    _x.resize(numVars, 0.0f);
-    _b.resize(numVars, 0.0f);
-
-    for (size_t i { 0 }, iEnd { _i2Pos.size() }; i < iEnd; ++i)
+    size_t const numVars { i2Pos.size() };
+    bool         hasWalls { false };
+    for (size_t i { 0 }; i < numVars; ++i)
     {
-        _A[i * numVars + i] = -4 + static_cast<float>(_i2NumNeighboringWalls[i]);
+        uint32_t numNeighboringWalls { 0 };
 
-        size_t const idx { GetIndex(_i2Pos[i].y, _i2Pos[i].x) };
+        A.rowStarts.push_back(static_cast<uint32_t>(A.columns.size()));
         for (auto& offset : offsets)
         {
-            if (!Inside(_i2Pos[i].y + offset[0], _i2Pos[i].x + offset[1]))
+            if (!Inside(i2Pos[i].y + offset[0], i2Pos[i].x + offset[1]))
+            {
+                ++numNeighboringWalls;
                 continue;
+            }
 
             auto const offsetAppliedIdx {
-                GetIndex(_i2Pos[i].y + offset[0], _i2Pos[i].x + offset[1]),
+                GetIndex(i2Pos[i].y + offset[0], i2Pos[i].x + offset[1]),
             };
             switch (input[offsetAppliedIdx].type)
             {
             case PointType::Boundary:
             {
-                _b[i] -= input[offsetAppliedIdx].temp;
+                boundaryTerms.push_back(BoundaryTerm {
+                    static_cast<uint32_t>(i),
+                    static_cast<uint32_t>(offsetAppliedIdx),
+                });
                 break;
             }
             case PointType::GroundTruth:
             {
-                size_t const offsetAppliedI { _pos2I[offsetAppliedIdx] };
-                _A[i * numVars + offsetAppliedI] += 1;
+                A.columns.push_back(static_cast<uint32_t>(pos2I[offsetAppliedIdx]));
+                A.values.push_back(1.0f);
+                break;
+            }
+            case PointType::OutOfRange:
+            {
+                ++numNeighboringWalls;
                 break;
             }
             }
         }
+
+        A.diagonal.push_back(-4 + static_cast<float>(numNeighboringWalls));
+        hasWalls = hasWalls || numNeighboringWalls != 0;
     }
+    A.rowStarts.push_back(static_cast<uint32_t>(A.columns.size()));
 
-    return true;
+    return hasWalls;
+}
+
+void MatrixSpace::GetNestedDissectionOrder(std::vector<uint32_t>& order) const
+{
+    order.resize(_i2Pos.size());
+    for (size_t i { 0 }; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    Dissect(_i2Pos, order.data(), order.data() + order.size());
+}
+
+void MatrixSpace::BuildRightHandSide(Point const* input) noexcept
+{
+    std::fill(_b.begin(), _b.end(), 0.0f);
+    for (auto& term : _boundaryTerms) _b[term.i] -= input[term.inputIdx].temp;
 }
 
 void MatrixSpace::CopyResults(Point const* input, float* output) noexcept
@@ -154,6 +366,8 @@ void MatrixSpace::CopyResults(Point const* input, float* output) noexcept
             size_t idx { GetIndex(i, j) };
             if (input[idx].type == PointType::Boundary)
                 output[idx] = input[idx].temp;
+            else if (input[idx].type == PointType::OutOfRange)
+                output[idx] = 0.0f;
         }
     }
 }
\ No newline at end of file
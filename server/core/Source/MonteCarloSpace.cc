@@ -3,10 +3,43 @@
 
 #include <leth/MonteCarloSpace.hh>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <limits>
 #include <random>
 #include <vector>
 
+namespace
+{
+
+constexpr uint32_t defaultNumWalks { 1000 };
+constexpr uint32_t numPilotWalks { 16 };
+constexpr size_t   chunkSize { 64 };
+constexpr size_t   numLanes { 16 };
+
+}
+
+MonteCarloSpace::MonteCarloSpace(uint16_t width, uint16_t height, SpaceConfig const& config) :
+    Space { width, height },
+    _numWalks { config.numWalks != 0 ? config.numWalks : defaultNumWalks },
+    _targetError { config.tolerance },
+    _timeBudget { config.timeBudgetMs },
+    _workers { config.numThreads }
+{
+    std::random_device device;
+    for (uint32_t i { 0 }, iEnd { _workers.GetNumThreads() }; i < iEnd; ++i)
+        _engines.emplace_back((static_cast<uint64_t>(device()) << 32) | device());
+
+    // Every buffer is sized for the whole grid up front, so a run never allocates
+    _sanityCheckVisitMap.reserve(static_cast<size_t>(width) * height);
+    _sanityCheckStack.reserve(static_cast<size_t>(width) * height);
+    _cells.reserve(static_cast<size_t>(width) * height);
+    _cellStats.reserve(static_cast<size_t>(width) * height);
+    _paddedCells.reserve((static_cast<size_t>(width) + 2) * (height + 2));
+    _paddedTemps.reserve((static_cast<size_t>(width) + 2) * (height + 2));
+}
+
 char const* MonteCarloSpace::GetName() noexcept
 {
     return "Monte Carlo";
@@ -28,6 +61,16 @@ char const* MonteCarloSpace::GetErrorMessageInternal(ErrorType errorCode) noexce
     return "Unknown error";
 }
 
+bool MonteCarloSpace::EstimatesErrors() noexcept
+{
+    return true;
+}
+
+void MonteCarloSpace::SetThreadPolicy(ThreadPolicy const& policy) noexcept
+{
+    _workers.SetThreadPolicy(policy);
+}
+
 ErrorCode MonteCarloSpace::RunSimulation(Point const* input, float* output) noexcept
 {
     return static_cast<ErrorCode>(RunSimulationInternal(input, output));
@@ -36,130 +79,294 @@ ErrorCode MonteCarloSpace::RunSimulation(Point const* input, float* output) noex
 MonteCarloSpace::ErrorType MonteCarloSpace::RunSimulationInternal(Point const* input,
                                                                   float*       output) noexcept
 {
-    for (uint16_t i { 0 }, iEnd { height() }; i < iEnd; ++i)
+    if (!CheckSanity(input))
+        return ErrorType::InvalidEquation;
+
+    auto const start { std::chrono::steady_clock::now() };
+    BuildPaddedGrid(input);
+
+    // Only the unknown points are sampled; the others are exact
+    float* const errors { standardErrors() };
+    _cells.clear();
+    for (size_t idx { 0 }, idxEnd { static_cast<size_t>(width()) * height() }; idx < idxEnd; ++idx)
     {
-        for (uint16_t j { 0 }, jEnd { width() }; j < jEnd; ++j)
+        if (input[idx].type == PointType::GroundTruth)
+            _cells.push_back(static_cast<uint32_t>(idx));
+        else
         {
-            if (!CheckSanity(input, i, j))
-                return ErrorType::InvalidEquation;
+            output[idx] = input[idx].type == PointType::Boundary ? input[idx].temp : 0.0f;
+            if (errors != nullptr)
+                errors[idx] = 0.0f;
         }
     }
 
-    for (uint16_t i { 0 }, iEnd { height() }; i < iEnd; ++i)
+    uint32_t const numPilot { std::min(_numWalks, numPilotWalks) };
+    uint64_t const walkBudget { static_cast<uint64_t>(_numWalks) * _cells.size() };
+    uint64_t       numWalks { static_cast<uint64_t>(numPilot) * _cells.size() };
+    uint32_t       numRounds { 0 };
+    double         pooledVariance { 0.0 };
+    double         maxError { 0.0 };
+    _cellStats.assign(_cells.size(), CellStats { 0, numPilot, 0.0, 0.0 });
+    while (true)
     {
-        for (uint16_t j { 0 }, jEnd { width() }; j < jEnd; ++j)
+        RunPendingWalks();
+        ++numRounds;
+
+        double   sumM2 { 0.0 };
+        uint64_t numDegrees { 0 };
+        for (auto& cell : _cellStats)
         {
-            float sum { 0 };
-            for (int repeat { 0 }; repeat < 1000; ++repeat) sum += DoMonteCarlo(input, i, j);
-            output[GetIndex(i, j)] = sum / 1000;
+            sumM2 += cell.m2;
+            numDegrees += cell.numWalks - 1;
         }
-    }
+        pooledVariance = numDegrees != 0 ? sumM2 / numDegrees : 0.0;
 
-    return ErrorType::Success;
-}
+        double maxVarianceOfMean { 0.0 };
+        for (auto& cell : _cellStats)
+        {
+            maxVarianceOfMean
+                = std::max(maxVarianceOfMean, GetVarianceOfMean(cell, pooledVariance));
+        }
+        maxError = std::sqrt(maxVarianceOfMean);
 
-bool MonteCarloSpace::CheckSanity(Point const* input, uint16_t i, uint16_t j) noexcept
-{
+        if (maxError <= _targetError || numWalks >= walkBudget)
+            break;
 
-    int16_t x { static_cast<int16_t>(j) }, y { static_cast<int16_t>(i) };
-    if (!Inside(y, x))
-        return true;
+        if (_timeBudget.count() != 0 && std::chrono::steady_clock::now() - start >= _timeBudget)
+            break;
 
-    auto idx { GetIndex(y, x) };
-    if (input[idx].type != PointType::GroundTruth)
-        return true;
+        // Narrows the widest half of the intervals, at most doubling the walks of a point per round
+        // as its variance estimate is still rough
+        double const threshold { std::max(static_cast<double>(_targetError), 0.5 * maxError) };
+        double const thresholdVariance { threshold * threshold };
+        uint64_t     numAllocated { 0 };
+        for (auto& cell : _cellStats)
+        {
+            double const varianceOfMean { GetVarianceOfMean(cell, pooledVariance) };
+            if (varianceOfMean <= thresholdVariance)
+                continue;
 
-    constexpr int16_t offsets[4][2] {
-        { -1, 0 },
-        { 0, 1 },
-        { 1, 0 },
-        { 0, -1 },
-    };
+            double const needed { cell.numWalks * (varianceOfMean / thresholdVariance - 1.0) };
+            cell.numPendingWalks = static_cast<uint32_t>(
+                std::min(std::ceil(needed), static_cast<double>(cell.numWalks)));
+            numAllocated += cell.numPendingWalks;
+        }
 
-    _sanityCheckVisitMap.resize(static_cast<size_t>(width()) * height());
-    std::fill(_sanityCheckVisitMap.begin(), _sanityCheckVisitMap.end(), false);
-    _sanityCheckVisitMap[idx] = true;
+        // Scales the round down to the rest of the budget
+        uint64_t const numRemaining { walkBudget - numWalks };
+        if (numAllocated > numRemaining)
+        {
+            double const scale { static_cast<double>(numRemaining) / numAllocated };
+
+            numAllocated = 0;
+            for (auto& cell : _cellStats)
+            {
+                if (cell.numPendingWalks == 0)
+                    continue;
+
+                cell.numPendingWalks = std::max(
+                    1u, static_cast<uint32_t>(cell.numPendingWalks * scale));
+                numAllocated += cell.numPendingWalks;
+            }
+        }
+        numWalks += numAllocated;
+    }
 
-    std::vector<Pos> stack;
-    stack.push_back(Pos { static_cast<uint16_t>(x), static_cast<uint16_t>(y) });
-    while (!stack.empty())
+    for (size_t k { 0 }; k < _cells.size(); ++k)
     {
-        Pos back { stack.back() };
-        stack.pop_back();
+        output[_cells[k]] = static_cast<float>(_cellStats[k].mean);
+        if (errors != nullptr)
+        {
+            errors[_cells[k]]
+                = static_cast<float>(std::sqrt(GetVarianceOfMean(_cellStats[k], pooledVariance)));
+        }
+    }
 
-        if (!Inside(back.y, back.x))
-            continue;
+    stats().numIterations    = numRounds;
+    stats().numSamples       = numWalks;
+    stats().maxStandardError = static_cast<float>(maxError);
 
-        auto idx { GetIndex(back.y, back.x) };
-        if (input[idx].type == PointType::Boundary)
-            return true;
+    return ErrorType::Success;
+}
 
-        if (input[idx].type == PointType::OutOfRange)
-            continue;
+void MonteCarloSpace::BuildPaddedGrid(Point const* input) noexcept
+{
+    size_t const paddedWidth { static_cast<size_t>(width()) + 2 };
+    _paddedCells.assign(paddedWidth * (height() + 2), CellClass::Reflecting);
+    _paddedTemps.assign(paddedWidth * (height() + 2), 0.0f);
 
-        for (auto& offset : offsets)
+    for (uint16_t i { 0 }, iEnd { height() }; i < iEnd; ++i)
+    {
+        for (uint16_t j { 0 }, jEnd { width() }; j < jEnd; ++j)
         {
-            if (!Inside(back.y + offset[0], back.x + offset[1]))
-                continue;
-
-            auto newIdx { GetIndex(back.y + offset[0], back.x + offset[1]) };
-            if (_sanityCheckVisitMap[newIdx])
-                continue;
-
-            _sanityCheckVisitMap[newIdx] = true;
-            stack.push_back(Pos {
-                static_cast<uint16_t>(back.x + offset[1]),
-                static_cast<uint16_t>(back.y + offset[0]),
-            });
+            Point const& point { input[GetIndex(i, j)] };
+            size_t const paddedIdx { (i + 1) * paddedWidth + j + 1 };
+            switch (point.type)
+            {
+            case PointType::GroundTruth: _paddedCells[paddedIdx] = CellClass::Interior; break;
+            case PointType::Boundary:
+                _paddedCells[paddedIdx] = CellClass::Absorbing;
+                _paddedTemps[paddedIdx] = point.temp;
+                break;
+            case PointType::OutOfRange: break;
+            }
         }
     }
-
-    return false;
 }
 
-float MonteCarloSpace::DoMonteCarlo(Point const* input, uint16_t i, uint16_t j) noexcept
+void MonteCarloSpace::RunPendingWalks() noexcept
 {
-    std::uniform_int_distribution<int> dist { 0, 3 };
+    size_t const numChunks { (_cells.size() + chunkSize - 1) / chunkSize };
+    _workers.ParallelFor(0, numChunks, [this](size_t chunk, uint32_t workerIdx) {
+        size_t const begin { chunk * chunkSize };
+        size_t const end { std::min(_cells.size(), begin + chunkSize) };
+
+        RunWalks(begin, end, _engines[workerIdx]);
+        for (size_t k { begin }; k < end; ++k) _cellStats[k].numPendingWalks = 0;
+    });
+}
 
-    int16_t beforeX, beforeY;
-    int16_t x { static_cast<int16_t>(j) }, y { static_cast<int16_t>(i) };
+void MonteCarloSpace::RunWalks(size_t begin, size_t end, Xoshiro256& eng) noexcept
+{
+    int32_t const paddedWidth { static_cast<int32_t>(width()) + 2 };
+    int32_t const offsets[4] { -paddedWidth, 1, paddedWidth, -1 };
 
-    if (!Inside(y, x))
-        return 0.0f;
+    CellClass const* const cells { _paddedCells.data() };
+    float const* const     temps { _paddedTemps.data() };
 
-    auto idx { GetIndex(y, x) };
-    if (input[idx].type == PointType::OutOfRange)
-        return 0.0f;
+    std::array<int32_t, numLanes> positions;
+    std::array<size_t, numLanes>  owners;
+    std::array<uint8_t, numLanes> active, absorbed;
 
-    while (true)
-    {
-        if (!Inside(y, x))
+    // Hands out the pending walks of the points one at a time
+    size_t     next { begin };
+    uint32_t   numLeft { begin < end ? _cellStats[begin].numPendingWalks : 0 };
+    auto const startWalk { [&](size_t lane) -> bool {
+        while (numLeft == 0)
         {
-            x = beforeX;
-            y = beforeY;
-            continue;
+            if (next >= end || ++next >= end)
+                return false;
+
+            numLeft = _cellStats[next].numPendingWalks;
         }
+        --numLeft;
 
-        auto idx { GetIndex(y, x) };
-        if (input[idx].type == PointType::Boundary)
-            return input[idx].temp;
+        owners[lane]    = next;
+        positions[lane] = (static_cast<int32_t>(_cells[next] / width()) + 1) * paddedWidth
+                          + static_cast<int32_t>(_cells[next] % width()) + 1;
+        return true;
+    } };
+
+    // Finished lanes keep walking from the first point of the grid, masked out
+    int32_t const parking { paddedWidth + 1 };
+    size_t        numActive { 0 };
+    for (size_t lane { 0 }; lane < numLanes; ++lane)
+    {
+        active[lane] = startWalk(lane);
+        if (active[lane])
+            ++numActive;
+        else
+            positions[lane] = parking;
+    }
 
-        if (input[idx].type == PointType::OutOfRange)
+    while (numActive != 0)
+    {
+        // 16 lanes take two bits each, so a draw lasts for two steps
+        uint64_t bits { eng.Next() };
+        for (int step { 0 }; step < 2; ++step, bits >>= 2 * numLanes)
         {
-            x = beforeX;
-            y = beforeY;
-            continue;
+            uint8_t anyAbsorbed { 0 };
+            for (size_t lane { 0 }; lane < numLanes; ++lane)
+            {
+                int32_t const   candidate { positions[lane] + offsets[(bits >> (2 * lane)) & 3] };
+                CellClass const cellClass { cells[candidate] };
+
+                positions[lane] = cellClass == CellClass::Reflecting ? positions[lane] : candidate;
+                absorbed[lane]  = (cellClass == CellClass::Absorbing) & active[lane];
+                anyAbsorbed |= absorbed[lane];
+            }
+
+            if (!anyAbsorbed)
+                continue;
+
+            for (size_t lane { 0 }; lane < numLanes; ++lane)
+            {
+                if (!absorbed[lane])
+                    continue;
+
+                CellStats&   cell { _cellStats[owners[lane]] };
+                double const value { temps[positions[lane]] };
+                double const delta { value - cell.mean };
+
+                ++cell.numWalks;
+                cell.mean += delta / cell.numWalks;
+                cell.m2 += delta * (value - cell.mean);
+
+                if (!startWalk(lane))
+                {
+                    active[lane]    = 0;
+                    positions[lane] = parking;
+                    --numActive;
+                }
+            }
         }
+    }
+}
 
-        beforeX = x;
-        beforeY = y;
+double MonteCarloSpace::GetVarianceOfMean(CellStats const& cell,
+                                          double           pooledVariance) const noexcept
+{
+    // The prior counts as one extra degree of freedom on top of the n - 1 of the walks
+    double const variance { (cell.m2 + pooledVariance) / cell.numWalks };
+    return variance / cell.numWalks;
+}
 
-        switch (dist(_eng))
+bool MonteCarloSpace::CheckSanity(Point const* input) noexcept
+{
+    // Floods the unknown points from every boundary at once. An unknown point that is not reached
+    // is enclosed by walls, so its equation has no solution.
+    size_t const w { width() };
+    size_t const size { w * height() };
+    _sanityCheckVisitMap.assign(size, false);
+    _sanityCheckStack.clear();
+    for (size_t idx { 0 }; idx < size; ++idx)
+    {
+        if (input[idx].type == PointType::Boundary)
         {
-        case 0: --y; break;
-        case 1: ++x; break;
-        case 2: ++y; break;
-        case 3: --x; break;
+            _sanityCheckVisitMap[idx] = true;
+            _sanityCheckStack.push_back(static_cast<uint32_t>(idx));
         }
     }
+
+    auto const visit { [&](size_t idx) {
+        if (_sanityCheckVisitMap[idx] || input[idx].type != PointType::GroundTruth)
+            return;
+
+        _sanityCheckVisitMap[idx] = true;
+        _sanityCheckStack.push_back(static_cast<uint32_t>(idx));
+    } };
+
+    while (!_sanityCheckStack.empty())
+    {
+        size_t const idx { _sanityCheckStack.back() };
+        _sanityCheckStack.pop_back();
+
+        size_t const j { idx % w };
+        if (idx >= w)
+            visit(idx - w);
+        if (idx + w < size)
+            visit(idx + w);
+        if (j > 0)
+            visit(idx - 1);
+        if (j + 1 < w)
+            visit(idx + 1);
+    }
+
+    for (size_t idx { 0 }; idx < size; ++idx)
+    {
+        if (input[idx].type == PointType::GroundTruth && !_sanityCheckVisitMap[idx])
+            return false;
+    }
+
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,490 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/ResultEncoding.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+constexpr char     frameMagic[4] { 'L', 'E', 'T', 'Q' };
+constexpr size_t   headerSize { 32 };
+constexpr size_t   blockLength { 64 };
+constexpr uint32_t maxQuantized { 0xffff };
+constexpr uint32_t escapeLength { 16 };
+
+struct FrameHeader
+{
+    uint32_t flags;
+    uint32_t length;
+    float    offset;
+    float    scale;
+    float    maxError;
+    uint64_t generation;
+};
+
+uint32_t ToFlags(ResultEncodingFlag flag) noexcept
+{
+    return static_cast<uint32_t>(flag);
+}
+
+void PutU32(uint8_t* out, uint32_t value) noexcept
+{
+    for (int i { 0 }; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint32_t GetU32(uint8_t const* in) noexcept
+{
+    uint32_t value { 0 };
+    for (int i { 0 }; i < 4; ++i) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return value;
+}
+
+void PutF32(uint8_t* out, float value) noexcept
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    PutU32(out, bits);
+}
+
+float GetF32(uint8_t const* in) noexcept
+{
+    uint32_t const bits { GetU32(in) };
+    float          value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void WriteHeader(uint8_t* out, FrameHeader const& header) noexcept
+{
+    std::memcpy(out, frameMagic, sizeof(frameMagic));
+    PutU32(out + 4, header.flags);
+    PutU32(out + 8, header.length);
+    PutF32(out + 12, header.offset);
+    PutF32(out + 16, header.scale);
+    PutF32(out + 20, header.maxError);
+    PutU32(out + 24, static_cast<uint32_t>(header.generation));
+    PutU32(out + 28, static_cast<uint32_t>(header.generation >> 32));
+}
+
+bool ReadHeader(uint8_t const* in, size_t size, FrameHeader& header) noexcept
+{
+    if (in == nullptr || size < headerSize || std::memcmp(in, frameMagic, sizeof(frameMagic)) != 0)
+        return false;
+
+    header.flags      = GetU32(in + 4);
+    header.length     = GetU32(in + 8);
+    header.offset     = GetF32(in + 12);
+    header.scale      = GetF32(in + 16);
+    header.maxError   = GetF32(in + 20);
+    header.generation = GetU32(in + 24) | (static_cast<uint64_t>(GetU32(in + 28)) << 32);
+    return true;
+}
+
+float Dequantize(uint16_t quantized, float offset, float scale) noexcept
+{
+    return static_cast<float>(offset + static_cast<double>(quantized) * scale);
+}
+
+uint16_t ToZigZag(uint16_t residual) noexcept
+{
+    int16_t const signedResidual { static_cast<int16_t>(residual) };
+    return static_cast<uint16_t>((static_cast<uint32_t>(signedResidual) << 1)
+                                 ^ static_cast<uint32_t>(signedResidual >> 15));
+}
+
+uint16_t FromZigZag(uint16_t zigZag) noexcept
+{
+    return static_cast<uint16_t>((zigZag >> 1) ^ (0u - (zigZag & 1u)));
+}
+
+class BitWriter
+{
+  private:
+    std::vector<uint8_t>& _out;
+    uint64_t              _buffer;
+    uint32_t              _numBits;
+
+  public:
+    BitWriter(std::vector<uint8_t>& out) : _out { out }, _buffer { 0 }, _numBits { 0 } {}
+
+    void Write(uint32_t value, uint32_t numBits)
+    {
+        _buffer |= static_cast<uint64_t>(value) << _numBits;
+        _numBits += numBits;
+        while (_numBits >= 8)
+        {
+            _out.push_back(static_cast<uint8_t>(_buffer));
+            _buffer >>= 8;
+            _numBits -= 8;
+        }
+    }
+
+    void Flush()
+    {
+        if (_numBits != 0)
+            _out.push_back(static_cast<uint8_t>(_buffer));
+
+        _buffer  = 0;
+        _numBits = 0;
+    }
+};
+
+class BitReader
+{
+  private:
+    uint8_t const* _in;
+    size_t         _size, _offset;
+    uint64_t       _buffer;
+    uint32_t       _numBits;
+
+  public:
+    BitReader(uint8_t const* in, size_t size) :
+        _in { in },
+        _size { size },
+        _offset { 0 },
+        _buffer { 0 },
+        _numBits { 0 }
+    {}
+
+    bool Read(uint32_t numBits, uint32_t& value) noexcept
+    {
+        while (_numBits < numBits)
+        {
+            if (_offset >= _size)
+                return false;
+
+            _buffer |= static_cast<uint64_t>(_in[_offset++]) << _numBits;
+            _numBits += 8;
+        }
+
+        value = static_cast<uint32_t>(_buffer & ((uint64_t { 1 } << numBits) - 1));
+        _buffer >>= numBits;
+        _numBits -= numBits;
+        return true;
+    }
+};
+
+/// Writes zigzag-encoded residuals with a Rice code whose parameter is chosen per block. Quotients
+/// of `escapeLength` or more are escaped and followed by the raw 16-bit value.
+void EncodeRice(uint16_t const* values, size_t length, std::vector<uint8_t>& out)
+{
+    BitWriter writer { out };
+    for (size_t begin { 0 }; begin < length; begin += blockLength)
+    {
+        size_t const end { std::min(length, begin + blockLength) };
+
+        uint32_t bestK { 0 };
+        uint64_t bestCost { std::numeric_limits<uint64_t>::max() };
+        for (uint32_t k { 0 }; k < 16; ++k)
+        {
+            uint64_t cost { 0 };
+            for (size_t i { begin }; i < end; ++i)
+            {
+                uint32_t const quotient { static_cast<uint32_t>(values[i]) >> k };
+                cost += quotient >= escapeLength ? escapeLength + 16 : quotient + 1 + k;
+            }
+
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestK    = k;
+            }
+        }
+
+        writer.Write(bestK, 4);
+        for (size_t i { begin }; i < end; ++i)
+        {
+            uint32_t const quotient { static_cast<uint32_t>(values[i]) >> bestK };
+            if (quotient >= escapeLength)
+            {
+                writer.Write((1u << escapeLength) - 1, escapeLength);
+                writer.Write(values[i], 16);
+                continue;
+            }
+
+            writer.Write((1u << quotient) - 1, quotient + 1);
+            writer.Write(values[i] & ((1u << bestK) - 1), bestK);
+        }
+    }
+    writer.Flush();
+}
+
+bool DecodeRice(uint8_t const* in, size_t size, uint16_t* values, size_t length) noexcept
+{
+    BitReader reader { in, size };
+    for (size_t begin { 0 }; begin < length; begin += blockLength)
+    {
+        size_t const end { std::min(length, begin + blockLength) };
+
+        uint32_t k;
+        if (!reader.Read(4, k))
+            return false;
+
+        for (size_t i { begin }; i < end; ++i)
+        {
+            uint32_t quotient { 0 }, bit;
+            while (quotient < escapeLength)
+            {
+                if (!reader.Read(1, bit))
+                    return false;
+                if (bit == 0)
+                    break;
+                ++quotient;
+            }
+
+            uint32_t remainder;
+            if (quotient == escapeLength)
+            {
+                if (!reader.Read(16, remainder))
+                    return false;
+                values[i] = static_cast<uint16_t>(remainder);
+                continue;
+            }
+
+            if (!reader.Read(k, remainder))
+                return false;
+            values[i] = static_cast<uint16_t>((quotient << k) | remainder);
+        }
+    }
+    return true;
+}
+
+/// Returns whether a payload of the given size can hold the number of values in the header. A
+/// Rice-coded value takes at least one bit, and every block starts with a 4-bit parameter.
+bool CanHoldLength(FrameHeader const& header, size_t payloadSize) noexcept
+{
+    uint64_t const length { header.length };
+    if (!(header.flags & ToFlags(ResultEncodingFlag::Entropy)))
+        return payloadSize / 2 >= length;
+
+    uint64_t const numBlocks { (length + blockLength - 1) / blockLength };
+    return payloadSize >= (length + 4 * numBlocks + 7) / 8;
+}
+
+/// Decodes the quantized values of a frame of `length` values. `reference` must be a
+/// self-contained frame if `encoded` is a delta frame. The header is validated before anything is
+/// allocated, as the frame may come from an untrusted source.
+bool DecodeQuantized(uint8_t const*         encoded,
+                     size_t                 encodedSize,
+                     uint8_t const*         reference,
+                     size_t                 referenceSize,
+                     size_t                 length,
+                     FrameHeader&           header,
+                     std::vector<uint16_t>& quantized)
+{
+    if (!ReadHeader(encoded, encodedSize, header) || header.length != length
+        || !CanHoldLength(header, encodedSize - headerSize))
+        return false;
+
+    std::vector<uint16_t> predictions;
+    if (header.flags & ToFlags(ResultEncodingFlag::Delta))
+    {
+        FrameHeader referenceHeader;
+        if (!ReadHeader(reference, referenceSize, referenceHeader)
+            || (referenceHeader.flags & ToFlags(ResultEncodingFlag::Delta))
+            || !DecodeQuantized(
+                reference, referenceSize, nullptr, 0, length, referenceHeader, predictions))
+            return false;
+    }
+
+    uint8_t const* payload { encoded + headerSize };
+    size_t const   payloadSize { encodedSize - headerSize };
+
+    quantized.resize(header.length);
+    if (header.flags & ToFlags(ResultEncodingFlag::Entropy))
+    {
+        if (!DecodeRice(payload, payloadSize, quantized.data(), quantized.size()))
+            return false;
+
+        for (auto& value : quantized) value = FromZigZag(value);
+    }
+    else
+    {
+        if (payloadSize < quantized.size() * 2)
+            return false;
+
+        for (size_t i { 0 }; i < quantized.size(); ++i)
+            quantized[i] = static_cast<uint16_t>(payload[2 * i] | (payload[2 * i + 1] << 8));
+    }
+
+    // Residuals are relative to the reference frame, or to the previous value of this frame
+    for (size_t i { 0 }; i < quantized.size(); ++i)
+    {
+        uint16_t const prediction {
+            predictions.empty() ? (i == 0 ? uint16_t { 0 } : quantized[i - 1]) : predictions[i],
+        };
+        quantized[i] = static_cast<uint16_t>(quantized[i] + prediction);
+    }
+
+    return true;
+}
+
+}
+
+size_t GetEncodedResultBound(size_t length) noexcept
+{
+    return headerSize + 2 * length;
+}
+
+size_t EncodeResult(float const*   temp,
+                    size_t         length,
+                    uint64_t       generation,
+                    uint32_t       flags,
+                    uint8_t const* reference,
+                    size_t         referenceSize,
+                    uint8_t*       out,
+                    float*         maxError) noexcept
+try
+{
+    if (length > std::numeric_limits<uint32_t>::max())
+        return 0;
+
+    FrameHeader header {};
+    header.flags      = flags & ToFlags(ResultEncodingFlag::Entropy);
+    header.length     = static_cast<uint32_t>(length);
+    header.generation = generation;
+
+    float minValue { std::numeric_limits<float>::infinity() };
+    float maxValue { -std::numeric_limits<float>::infinity() };
+    for (size_t i { 0 }; i < length; ++i)
+    {
+        if (!std::isfinite(temp[i]))
+            continue;
+
+        minValue = std::min(minValue, temp[i]);
+        maxValue = std::max(maxValue, temp[i]);
+    }
+    if (minValue > maxValue)
+        minValue = maxValue = 0.0f;
+
+    header.offset = minValue;
+    header.scale  = static_cast<float>((static_cast<double>(maxValue) - minValue) / maxQuantized);
+
+    std::vector<uint16_t> predictions;
+    if (flags & ToFlags(ResultEncodingFlag::Delta))
+    {
+        FrameHeader referenceHeader;
+        if (ReadHeader(reference, referenceSize, referenceHeader)
+            && !(referenceHeader.flags & ToFlags(ResultEncodingFlag::Delta))
+            && DecodeQuantized(
+                reference, referenceSize, nullptr, 0, length, referenceHeader, predictions))
+        {
+            header.flags |= ToFlags(ResultEncodingFlag::Delta);
+
+            // Reuses the quantizer of the reference when it covers this frame, so unchanged
+            // values produce zero residuals
+            double const referenceMax { referenceHeader.offset
+                                        + static_cast<double>(referenceHeader.scale)
+                                              * maxQuantized };
+            if (referenceHeader.scale > 0.0f && referenceHeader.offset <= minValue
+                && maxValue <= referenceMax)
+            {
+                header.offset = referenceHeader.offset;
+                header.scale  = referenceHeader.scale;
+            }
+        }
+        else
+            predictions.clear();
+    }
+
+    std::vector<uint16_t> quantized(length);
+    float                 error { 0.0f };
+    for (size_t i { 0 }; i < length; ++i)
+    {
+        double value { std::isfinite(temp[i]) ? temp[i] : header.offset };
+        double q { header.scale > 0.0f ? std::round((value - header.offset) / header.scale) : 0.0 };
+        quantized[i] = static_cast<uint16_t>(std::min(std::max(q, 0.0), double { maxQuantized }));
+
+        if (std::isfinite(temp[i]))
+        {
+            error = std::max(error,
+                             std::abs(Dequantize(quantized[i], header.offset, header.scale)
+                                      - temp[i]));
+        }
+    }
+    header.maxError = error;
+
+    std::vector<uint16_t> residuals(length);
+    for (size_t i { 0 }; i < length; ++i)
+    {
+        uint16_t const prediction {
+            predictions.empty() ? (i == 0 ? uint16_t { 0 } : quantized[i - 1]) : predictions[i],
+        };
+        residuals[i] = static_cast<uint16_t>(quantized[i] - prediction);
+    }
+
+    uint8_t* payload { out + headerSize };
+    size_t   payloadSize { 2 * length };
+    if (header.flags & ToFlags(ResultEncodingFlag::Entropy))
+    {
+        for (auto& residual : residuals) residual = ToZigZag(residual);
+
+        std::vector<uint8_t> compressed;
+        compressed.reserve(2 * length);
+        EncodeRice(residuals.data(), length, compressed);
+
+        // Falls back to the raw form when the coder does not pay off
+        if (compressed.size() < payloadSize)
+        {
+            std::memcpy(payload, compressed.data(), compressed.size());
+            payloadSize = compressed.size();
+        }
+        else
+        {
+            header.flags &= ~ToFlags(ResultEncodingFlag::Entropy);
+            for (auto& residual : residuals) residual = FromZigZag(residual);
+        }
+    }
+
+    if (!(header.flags & ToFlags(ResultEncodingFlag::Entropy)))
+    {
+        for (size_t i { 0 }; i < length; ++i)
+        {
+            payload[2 * i]     = static_cast<uint8_t>(residuals[i]);
+            payload[2 * i + 1] = static_cast<uint8_t>(residuals[i] >> 8);
+        }
+    }
+
+    WriteHeader(out, header);
+    if (maxError != nullptr)
+        *maxError = header.maxError;
+
+    return headerSize + payloadSize;
+}
+catch (...)
+{
+    return 0;
+}
+
+bool DecodeResult(uint8_t const* encoded,
+                  size_t         encodedSize,
+                  uint8_t const* reference,
+                  size_t         referenceSize,
+                  float*         temp,
+                  size_t         length,
+                  uint64_t*      generation) noexcept
+try
+{
+    FrameHeader           header;
+    std::vector<uint16_t> quantized;
+    if (!DecodeQuantized(encoded, encodedSize, reference, referenceSize, length, header, quantized))
+        return false;
+
+    for (size_t i { 0 }; i < length; ++i)
+        temp[i] = Dequantize(quantized[i], header.offset, header.scale);
+
+    if (generation != nullptr)
+        *generation = header.generation;
+
+    return true;
+}
+catch (...)
+{
+    return false;
+}
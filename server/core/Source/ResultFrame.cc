@@ -0,0 +1,64 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/ResultFrame.hh>
+
+#pragma region ResultFrame
+
+ResultFrame::ResultFrame(ResultFramePool* pool, size_t length, bool hasStandardErrors) :
+    _pool { pool },
+    _refCount { 0 },
+    _temp(length, 0.0f),
+    _standardErrors(hasStandardErrors ? length : 0, 0.0f),
+    _errorCode { 0 },
+    _generation { 0 },
+    _stats {}
+{}
+
+void ResultFrame::Release() noexcept
+{
+    if (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        _pool->Return(this);
+}
+
+#pragma endregion ResultFrame
+
+#pragma region ResultFramePool
+
+ResultFramePool::ResultFramePool(size_t length, bool hasStandardErrors) :
+    _length { length },
+    _hasStandardErrors { hasStandardErrors }
+{}
+
+ResultFrame* ResultFramePool::Acquire()
+{
+    ResultFrame* frame;
+    {
+        std::lock_guard<std::mutex> guard { _lock };
+        if (_freeFrames.empty())
+        {
+            _frames.push_back(std::unique_ptr<ResultFrame> {
+                new ResultFrame { this, _length, _hasStandardErrors } });
+            _freeFrames.reserve(_frames.capacity());
+            frame = _frames.back().get();
+        }
+        else
+        {
+            frame = _freeFrames.back();
+            _freeFrames.pop_back();
+        }
+    }
+
+    frame->_refCount.store(1, std::memory_order_relaxed);
+    return frame;
+}
+
+void ResultFramePool::Return(ResultFrame* frame) noexcept
+{
+    std::lock_guard<std::mutex> guard { _lock };
+
+    // Cannot throw: the capacity always covers every frame of the pool
+    _freeFrames.push_back(frame);
+}
+
+#pragma endregion ResultFramePool
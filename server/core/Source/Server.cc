@@ -3,8 +3,11 @@
 
 #include <leth/Lib.hh>
 #include <leth/Point.hh>
+#include <leth/ResultEncoding.hh>
 #include <leth/Server.hh>
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 
 #define CAST_SERVER()                                                                              \
@@ -15,16 +18,34 @@
 
 #pragma region Creation
 
-Server::Server(uint16_t width, uint16_t height, std::vector<std::unique_ptr<Space>>&& spaces) :
+Server::Server(uint16_t                              width,
+               uint16_t                              height,
+               std::vector<std::unique_ptr<Space>>&& spaces,
+               uint32_t                              flags,
+               ThreadPolicy const&                   solverPolicy,
+               ThreadPolicy const&                   ingestionPolicy) :
     _width { width },
     _height { height },
     _spaces { std::move(spaces) },
     _stopped { false },
-    _queueConsumerThread { std::thread { &Server::ConsumeQueue, this } },
+    _flags { flags },
+    _solverPolicy { solverPolicy },
+    _ingestionPolicy { ingestionPolicy },
     _inputBuffer(GetBufferLength(), Point { PointType::GroundTruth, 0.0f }),
-    _outputBufferLocks(_spaces.size()),
-    _outputResults(_spaces.size(), 0)
+    _inputGeneration { 0 },
+    _outputFrameLocks(_spaces.size()),
+    _journal { width, height, static_cast<SpaceIndex>(_spaces.size()) },
+    _sharedResults { width, height, static_cast<SpaceIndex>(_spaces.size()) }
 {
+    for (size_t i { 0 }, length { _spaces.size() }; i < length; ++i)
+    {
+        _framePools.push_back(
+            std::make_unique<ResultFramePool>(GetBufferLength(), _spaces[i]->EstimatesErrors()));
+        _outputFrames.push_back(_framePools[i]->Acquire());
+    }
+
+    // Threads are started after every buffer they touch is constructed
+    _queueConsumerThread = std::thread { &Server::ConsumeQueue, this };
     for (size_t i { 0 }, length { _spaces.size() }; i < length; ++i)
     {
         _spaceThreads.push_back(std::thread {
@@ -33,10 +54,37 @@ Server::Server(uint16_t width, uint16_t height, std::vector<std::unique_ptr<Spac
             i,
             _spaces[i].get(),
         });
-        _outputBuffers.push_back(std::vector<float>(GetBufferLength(), 0.0f));
     }
 }
 
+Server* Server::Make(ServerConfig const& config, SpaceRegistry const& registry)
+{
+    if (config.spaces == nullptr && config.numSpaces != 0)
+        return nullptr;
+
+    std::vector<std::unique_ptr<Space>> rtn;
+    rtn.reserve(config.numSpaces);
+    for (uint32_t i { 0 }; i < config.numSpaces; ++i)
+    {
+        auto space { registry.Create(config.width, config.height, config.spaces[i]) };
+        if (space == nullptr)
+            return nullptr;
+
+        rtn.push_back(std::move(space));
+    }
+
+    ThreadPolicy const solverPolicy {
+        config.solverCpuMask,
+        config.solverNice,
+        (config.flags & static_cast<uint32_t>(ServerFlag::BatchScheduling)) != 0,
+    };
+    ThreadPolicy const ingestionPolicy { config.ingestionCpuMask, config.ingestionNice, false };
+
+    return new Server {
+        config.width, config.height, std::move(rtn), config.flags, solverPolicy, ingestionPolicy,
+    };
+}
+
 #pragma endregion Creation
 
 #pragma region GetNumberOfSpaces
@@ -80,10 +128,14 @@ char const* Server::GetErrorMessage(SpaceIndex spaceIdx, ErrorCode errorCode) no
     {
         return "Success";
     }
-    else if (errorCode == -1)
+    else if (errorCode == InvalidSpaceIndexError)
     {
         return "Invalid space index";
     }
+    else if (errorCode == BatchNotSupportedError)
+    {
+        return "Batches not supported";
+    }
     else if (spaceIdx >= _spaces.size())
         return "Unknown error";
     else
@@ -104,8 +156,11 @@ char const* leth_get_error_message(ServerHandle handle,
 
 void Server::SetPoint(uint16_t x, uint16_t y, float temp, PointType type) noexcept
 {
-    std::lock_guard<std::mutex> guard { _requestQueueLock };
-    _requestQueue.push_back(SetPointRequest { x, y, temp, type });
+    {
+        std::lock_guard<std::mutex> guard { _requestQueueLock };
+        _requestQueue.push_back(SetPointRequest { x, y, temp, type });
+    }
+    _requestQueueChanged.notify_one();
 }
 
 void leth_set(ServerHandle handle, uint16_t x, uint16_t y, float temp, PointType type) noexcept
@@ -138,17 +193,76 @@ void leth_get(ServerHandle handle, float* temp, PointType* type) noexcept
 
 #pragma endregion GetPoints
 
+#pragma region GetSnapshot
+
+uint64_t Server::GetSnapshot(float*     temp,
+                             PointType* type,
+                             float*     results,
+                             ErrorCode* errorCodes,
+                             uint64_t*  generations) noexcept
+{
+    size_t const length { GetBufferLength() };
+
+    // Results are copied before the input, so no result is newer than the returned input
+    for (SpaceIndex spaceIdx { 0 }, numSpaces { GetNumberOfSpaces() }; spaceIdx < numSpaces;
+         ++spaceIdx)
+    {
+        errorCodes[spaceIdx] = GetSimulationResult(spaceIdx,
+                                                   results + spaceIdx * length,
+                                                   generations + spaceIdx);
+    }
+
+    std::lock_guard<std::mutex> guard { _inputBufferLock };
+    for (size_t i { 0 }; i < length; ++i)
+    {
+        temp[i] = _inputBuffer[i].temp;
+        type[i] = _inputBuffer[i].type;
+    }
+
+    return _inputGeneration.load(std::memory_order_relaxed);
+}
+
+uint64_t leth_get_snapshot(ServerHandle handle,
+                           float*       temp,
+                           PointType*   type,
+                           float*       results,
+                           ErrorCode*   errorCodes,
+                           uint64_t*    generations) noexcept
+{
+    CAST_SERVER();
+    return server->GetSnapshot(temp, type, results, errorCodes, generations);
+}
+
+#pragma endregion GetSnapshot
+
 #pragma region GetSimulationResult
 
 ErrorCode Server::GetSimulationResult(SpaceIndex spaceIdx, float* temp) noexcept
 {
-    if (spaceIdx >= _spaces.size())
-        return -1;
+    uint64_t generation;
+    return GetSimulationResult(spaceIdx, temp, &generation);
+}
 
-    std::lock_guard<std::mutex> guard { _outputBufferLocks[spaceIdx] };
-    std::memcpy(temp, _outputBuffers[spaceIdx].data(), sizeof(float) * GetBufferLength());
+uint64_t Server::GetGeneration() noexcept
+{
+    return _inputGeneration.load(std::memory_order_acquire);
+}
 
-    return _outputResults[spaceIdx];
+ErrorCode Server::GetSimulationResult(SpaceIndex spaceIdx,
+                                      float*     temp,
+                                      uint64_t*  generation) noexcept
+{
+    ResultFrame* frame { AcquireSimulationResult(spaceIdx) };
+    if (frame == nullptr)
+        return InvalidSpaceIndexError;
+
+    std::memcpy(temp, frame->temp(), sizeof(float) * GetBufferLength());
+    *generation = frame->generation();
+
+    ErrorCode const errorCode { frame->errorCode() };
+    frame->Release();
+
+    return errorCode;
 }
 
 ErrorCode leth_get_res(ServerHandle handle, SpaceIndex spaceIdx, float* temp) noexcept
@@ -157,8 +271,320 @@ ErrorCode leth_get_res(ServerHandle handle, SpaceIndex spaceIdx, float* temp) no
     return server->GetSimulationResult(spaceIdx, temp);
 }
 
+uint64_t leth_get_generation(ServerHandle handle) noexcept
+{
+    CAST_SERVER();
+    return server->GetGeneration();
+}
+
+ErrorCode leth_get_res_with_generation(ServerHandle handle,
+                                       SpaceIndex   spaceIdx,
+                                       float*       temp,
+                                       uint64_t*    generation) noexcept
+{
+    CAST_SERVER();
+    return server->GetSimulationResult(spaceIdx, temp, generation);
+}
+
 #pragma endregion GetSimulationResult
 
+#pragma region AcquireSimulationResult
+
+ResultFrame* Server::AcquireSimulationResult(SpaceIndex spaceIdx) noexcept
+{
+    if (spaceIdx >= _spaces.size())
+        return nullptr;
+
+    std::lock_guard<std::mutex> guard { _outputFrameLocks[spaceIdx] };
+    _outputFrames[spaceIdx]->Retain();
+    return _outputFrames[spaceIdx];
+}
+
+void Server::ReleaseSimulationResult(ResultFrame* frame) noexcept
+{
+    if (frame != nullptr)
+        frame->Release();
+}
+
+ResultHandle leth_acquire_res(ServerHandle  handle,
+                              SpaceIndex    spaceIdx,
+                              float const** temp,
+                              ErrorCode*    errorCode,
+                              uint64_t*     generation) noexcept
+{
+    CAST_SERVER();
+    ResultFrame* frame { server->AcquireSimulationResult(spaceIdx) };
+    if (frame == nullptr)
+        return nullptr;
+
+    *temp = frame->temp();
+    if (errorCode != nullptr)
+        *errorCode = frame->errorCode();
+    if (generation != nullptr)
+        *generation = frame->generation();
+
+    return frame;
+}
+
+void leth_release_res(ServerHandle handle, ResultHandle result) noexcept
+{
+    CAST_SERVER();
+    server->ReleaseSimulationResult((ResultFrame*)result);
+}
+
+#pragma endregion AcquireSimulationResult
+
+#pragma region GetSimulationStats
+
+ErrorCode Server::GetSimulationStats(SpaceIndex spaceIdx, SpaceStats* stats) noexcept
+{
+    ResultFrame* frame { AcquireSimulationResult(spaceIdx) };
+    if (frame == nullptr)
+        return InvalidSpaceIndexError;
+
+    *stats = frame->stats();
+
+    ErrorCode const errorCode { frame->errorCode() };
+    frame->Release();
+
+    return errorCode;
+}
+
+ErrorCode leth_get_res_stats(ServerHandle handle, SpaceIndex spaceIdx, SpaceStats* stats) noexcept
+{
+    CAST_SERVER();
+    return server->GetSimulationStats(spaceIdx, stats);
+}
+
+#pragma endregion GetSimulationStats
+
+#pragma region GetSimulationError
+
+bool Server::GetSimulationError(SpaceIndex spaceIdx, float* error) noexcept
+{
+    ResultFrame* frame { AcquireSimulationResult(spaceIdx) };
+    if (frame == nullptr)
+        return false;
+
+    float const* standardErrors { frame->standardErrors() };
+    if (standardErrors != nullptr)
+        std::memcpy(error, standardErrors, sizeof(float) * GetBufferLength());
+
+    frame->Release();
+
+    return standardErrors != nullptr;
+}
+
+bool leth_get_res_error(ServerHandle handle, SpaceIndex spaceIdx, float* error) noexcept
+{
+    CAST_SERVER();
+    return server->GetSimulationError(spaceIdx, error);
+}
+
+#pragma endregion GetSimulationError
+
+#pragma region SolveBatch
+
+ErrorCode Server::SolveBatch(SpaceIndex       spaceIdx,
+                             PointType const* type,
+                             float const*     temps,
+                             uint32_t         numScenarios,
+                             float*           results,
+                             uint32_t         numThreads) noexcept
+{
+    if (spaceIdx >= _spaces.size())
+        return InvalidSpaceIndexError;
+
+    // The caller's thread is left alone; only the threads started for the batch get the policy
+    return _spaces[spaceIdx]->SolveBatch(
+        type, temps, numScenarios, results, numThreads, _solverPolicy);
+}
+
+ErrorCode leth_solve_batch(ServerHandle     handle,
+                           SpaceIndex       spaceIdx,
+                           PointType const* type,
+                           float const*     temps,
+                           uint32_t         numScenarios,
+                           float*           results,
+                           uint32_t         numThreads) noexcept
+{
+    CAST_SERVER();
+    return server->SolveBatch(spaceIdx, type, temps, numScenarios, results, numThreads);
+}
+
+#pragma endregion SolveBatch
+
+#pragma region GetEncodedSimulationResult
+
+size_t Server::GetEncodedSimulationResultBound() noexcept
+{
+    return GetEncodedResultBound(GetBufferLength());
+}
+
+ErrorCode Server::GetEncodedSimulationResult(SpaceIndex     spaceIdx,
+                                             uint32_t       flags,
+                                             uint8_t const* reference,
+                                             size_t         referenceSize,
+                                             uint8_t*       buffer,
+                                             size_t         bufferSize,
+                                             size_t*        encodedSize,
+                                             float*         maxError) noexcept
+{
+    *encodedSize = 0;
+
+    ResultFrame* frame { AcquireSimulationResult(spaceIdx) };
+    if (frame == nullptr)
+        return InvalidSpaceIndexError;
+
+    if (bufferSize >= GetEncodedSimulationResultBound())
+    {
+        *encodedSize = EncodeResult(frame->temp(),
+                                    GetBufferLength(),
+                                    frame->generation(),
+                                    flags,
+                                    reference,
+                                    referenceSize,
+                                    buffer,
+                                    maxError);
+    }
+
+    ErrorCode const errorCode { frame->errorCode() };
+    frame->Release();
+
+    return errorCode;
+}
+
+size_t leth_get_res_encoded_bound(ServerHandle handle) noexcept
+{
+    CAST_SERVER();
+    return server->GetEncodedSimulationResultBound();
+}
+
+ErrorCode leth_get_res_encoded(ServerHandle   handle,
+                               SpaceIndex     spaceIdx,
+                               uint32_t       flags,
+                               uint8_t const* reference,
+                               size_t         referenceSize,
+                               uint8_t*       buffer,
+                               size_t         bufferSize,
+                               size_t*        encodedSize,
+                               float*         maxError) noexcept
+{
+    CAST_SERVER();
+    return server->GetEncodedSimulationResult(spaceIdx,
+                                              flags,
+                                              reference,
+                                              referenceSize,
+                                              buffer,
+                                              bufferSize,
+                                              encodedSize,
+                                              maxError);
+}
+
+bool leth_decode_res(uint8_t const* encoded,
+                     size_t         encodedSize,
+                     uint8_t const* reference,
+                     size_t         referenceSize,
+                     float*         temp,
+                     size_t         length) noexcept
+{
+    return DecodeResult(encoded, encodedSize, reference, referenceSize, temp, length, nullptr);
+}
+
+#pragma endregion GetEncodedSimulationResult
+
+#pragma region Journal
+
+bool Server::StartJournal(char const* path,
+                          uint64_t    maxFileSize,
+                          uint32_t    checkpointIntervalMs) noexcept
+{
+    if (path == nullptr)
+        return false;
+
+    return _journal.Start(path, maxFileSize, checkpointIntervalMs);
+}
+
+void Server::StopJournal() noexcept
+{
+    _journal.Stop();
+}
+
+uint64_t Server::GetJournalDropped() noexcept
+{
+    return _journal.numDropped();
+}
+
+bool leth_start_journal(ServerHandle handle,
+                        char const*  path,
+                        uint64_t     maxFileSize,
+                        uint32_t     checkpointIntervalMs) noexcept
+{
+    CAST_SERVER();
+    return server->StartJournal(path, maxFileSize, checkpointIntervalMs);
+}
+
+void leth_stop_journal(ServerHandle handle) noexcept
+{
+    CAST_SERVER();
+    server->StopJournal();
+}
+
+uint64_t leth_get_journal_dropped(ServerHandle handle) noexcept
+{
+    CAST_SERVER();
+    return server->GetJournalDropped();
+}
+
+#pragma endregion Journal
+
+#pragma region SharedResults
+
+bool Server::StartSharedResults(char const* name, uint32_t numSlots) noexcept
+{
+    if (name == nullptr || !_sharedResults.Start(name, numSlots))
+        return false;
+
+    // Readers get the current input and results without waiting for the next update, which
+    // idle spaces would not produce
+    {
+        std::lock_guard<std::mutex> guard { _inputBufferLock };
+        _sharedResults.PublishInput(_inputBuffer.data(),
+                                    _inputGeneration.load(std::memory_order_relaxed));
+    }
+    for (size_t idx { 0 }, length { _spaces.size() }; idx < length; ++idx)
+    {
+        std::lock_guard<std::mutex> guard { _outputFrameLocks[idx] };
+        ResultFrame const&          frame { *_outputFrames[idx] };
+        _sharedResults.PublishResult(static_cast<SpaceIndex>(idx),
+                                     frame.errorCode(),
+                                     frame.generation(),
+                                     frame.stats(),
+                                     frame.temp());
+    }
+
+    return true;
+}
+
+void Server::StopSharedResults() noexcept
+{
+    _sharedResults.Stop();
+}
+
+bool leth_start_shared_results(ServerHandle handle, char const* name, uint32_t numSlots) noexcept
+{
+    CAST_SERVER();
+    return server->StartSharedResults(name, numSlots);
+}
+
+void leth_stop_shared_results(ServerHandle handle) noexcept
+{
+    CAST_SERVER();
+    server->StopSharedResults();
+}
+
+#pragma endregion SharedResults
+
 #pragma region Destruction
 
 void leth_delete(ServerHandle handle) noexcept
@@ -169,47 +595,181 @@ void leth_delete(ServerHandle handle) noexcept
 
 Server::~Server() noexcept
 {
-    _stopped = true;
+    {
+        std::lock_guard<std::mutex> queueGuard { _requestQueueLock };
+        std::lock_guard<std::mutex> inputGuard { _inputBufferLock };
+        _stopped = true;
+    }
+    _requestQueueChanged.notify_all();
+    _inputChanged.notify_all();
+
     _queueConsumerThread.join();
     for (auto& thread : _spaceThreads) thread.join();
+    _journal.Stop();
+    _sharedResults.Stop();
+
+    for (auto frame : _outputFrames) frame->Release();
 }
 
 #pragma endregion Destruction
 
 void Server::ConsumeQueue() noexcept
 {
-    while (!_stopped)
+    ApplyThreadPolicy(_ingestionPolicy);
+
+    // The queue is swapped with this buffer, so neither allocates once they have grown
+    std::vector<SetPointRequest> requests;
+    while (true)
     {
-        std::lock_guard<std::mutex> inputLockGuard { _inputBufferLock };
-        std::lock_guard<std::mutex> queueLockGuard { _requestQueueLock };
+        {
+            std::unique_lock<std::mutex> lock { _requestQueueLock };
+            _requestQueueChanged.wait(lock, [this] { return _stopped || !_requestQueue.empty(); });
+            if (_stopped)
+                return;
 
-        while (!_requestQueue.empty())
+            requests.swap(_requestQueue);
+        }
+
+        uint64_t generation;
         {
-            auto& request { _requestQueue.front() };
-            if (request.x < _width && request.y < _width)
+            std::lock_guard<std::mutex> guard { _inputBufferLock };
+            for (auto& request : requests)
             {
-                auto& point { _inputBuffer[request.x + request.y * _width] };
-                point.temp = request.temp;
-                point.type = request.type;
+                if (request.x < _width && request.y < _height)
+                {
+                    auto& point { _inputBuffer[request.x + request.y * _width] };
+                    point.temp = request.temp;
+                    point.type = request.type;
+                    _journal.RecordSetPoint(request.x, request.y, request.temp, request.type);
+                    _inputGeneration.fetch_add(1, std::memory_order_release);
+                }
             }
-            _requestQueue.pop_front();
+            generation = _inputGeneration.load(std::memory_order_relaxed);
         }
+        _inputChanged.notify_all();
+
+        // Only this thread writes the input buffer, so it can be read without the lock
+        _sharedResults.PublishInput(_inputBuffer.data(), generation);
+
+        requests.clear();
     }
 }
 
 void Server::CopyBufferAndRunSimulation(size_t idx, Space* space) noexcept
 {
+    ApplyThreadPolicy(_solverPolicy);
+    space->SetThreadPolicy(_solverPolicy);
+
+    bool const idleWhenConverged {
+        (_flags & static_cast<uint32_t>(ServerFlag::IdleWhenConverged)) != 0,
+    };
+
+    // Each run snapshots the input into the same buffer, which keeps its capacity
+    std::vector<Point> input(GetBufferLength());
+
+    RunContext context { this, idx, 0, {} };
+    space->_previewCallback = &Server::PublishPreview;
+    space->_previewContext  = &context;
+
+    uint64_t generation { 0 };
+    bool     idle { false };
     while (!_stopped)
     {
-        std::vector<Point> input;
         {
-            std::lock_guard<std::mutex> guard { _inputBufferLock };
-            input = _inputBuffer;
+            std::unique_lock<std::mutex> lock { _inputBufferLock };
+            if (idle)
+            {
+                // Simulating the same input again would only repeat the latest result
+                _inputChanged.wait(lock, [this, generation] {
+                    return _stopped
+                           || _inputGeneration.load(std::memory_order_relaxed) != generation;
+                });
+                if (_stopped)
+                    break;
+            }
+
+            std::copy(_inputBuffer.begin(), _inputBuffer.end(), input.begin());
+            generation = _inputGeneration.load(std::memory_order_relaxed);
         }
 
+        ResultFrame* frame;
+        try
         {
-            std::lock_guard<std::mutex> guard { _outputBufferLocks[idx] };
-            _outputResults[idx] = space->RunSimulation(input.data(), _outputBuffers[idx].data());
+            frame = _framePools[idx]->Acquire();
         }
+        catch (...)
+        {
+            // The pool could not grow. Waits for readers to release frames, or for memory to be
+            // freed, instead of retrying the allocation right away.
+            std::unique_lock<std::mutex> lock { _inputBufferLock };
+            _inputChanged.wait_for(lock, std::chrono::milliseconds { 10 }, [this] {
+                return _stopped.load();
+            });
+            continue;
+        }
+
+        auto const start { std::chrono::steady_clock::now() };
+        context.generation     = generation;
+        context.start          = start;
+        space->_stats          = SpaceStats {};
+        space->_standardErrors = frame->standardErrorData();
+
+        ErrorCode const errorCode { space->RunSimulation(input.data(), frame->data()) };
+        space->_stats.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count();
+        frame->SetResult(errorCode, generation, space->_stats);
+        _journal.RecordCheckpoint(static_cast<SpaceIndex>(idx), frame->errorCode(), frame->temp());
+        PublishSimulationResult(idx, frame);
+
+        idle = idleWhenConverged && space->HasConverged();
     }
+
+    space->_previewCallback = nullptr;
+    space->_previewContext  = nullptr;
+}
+
+void Server::PublishSimulationResult(size_t idx, ResultFrame* frame) noexcept
+{
+    ResultFrame* previous;
+    {
+        std::lock_guard<std::mutex> guard { _outputFrameLocks[idx] };
+        previous           = _outputFrames[idx];
+        _outputFrames[idx] = frame;
+    }
+
+    // Only this thread replaces the frame, so it stays alive without the lock. Publishing in the
+    // same order as the frames are swapped keeps the shared results in order.
+    _sharedResults.PublishResult(static_cast<SpaceIndex>(idx),
+                                 frame->errorCode(),
+                                 frame->generation(),
+                                 frame->stats(),
+                                 frame->temp());
+    previous->Release();
+}
+
+void Server::PublishPreview(void* context, float const* temp, uint32_t resolutionLevel) noexcept
+{
+    auto&   run { *static_cast<RunContext*>(context) };
+    Server& server { *run.server };
+
+    ResultFrame* frame;
+    try
+    {
+        frame = server._framePools[run.spaceIdx]->Acquire();
+    }
+    catch (...)
+    {
+        return;
+    }
+
+    SpaceStats stats { server._spaces[run.spaceIdx]->_stats };
+    stats.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - run.start)
+                          .count();
+    stats.resolutionLevel = resolutionLevel;
+
+    std::copy(temp, temp + server.GetBufferLength(), frame->data());
+    frame->SetResult(0, run.generation, stats);
+    server.PublishSimulationResult(run.spaceIdx, frame);
 }
\ No newline at end of file
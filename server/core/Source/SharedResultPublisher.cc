@@ -0,0 +1,235 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/SharedResults.hh>
+
+#include <cstring>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace
+{
+
+constexpr size_t cacheLineSize { 64 };
+
+size_t AlignToCacheLine(size_t size) noexcept
+{
+    return (size + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+}
+
+#ifndef _WIN32
+
+/// Returns whether `name` still refers to the shared memory object with the given identity.
+bool RefersTo(char const* name, uint64_t device, uint64_t inode) noexcept
+{
+    int const fd { shm_open(name, O_RDONLY, 0) };
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    bool const  same { fstat(fd, &status) == 0 && static_cast<uint64_t>(status.st_dev) == device
+                      && static_cast<uint64_t>(status.st_ino) == inode };
+    close(fd);
+    return same;
+}
+
+#endif
+
+}
+
+SharedResultPublisher::SharedResultPublisher(uint16_t   width,
+                                             uint16_t   height,
+                                             SpaceIndex numSpaces) :
+    _width { width },
+    _height { height },
+    _numSpaces { numSpaces },
+    _active { false },
+    _channelLocks(static_cast<size_t>(numSpaces) + 1),
+    _region { nullptr },
+    _regionSize { 0 },
+    _device { 0 },
+    _inode { 0 },
+    _numSlots { 0 },
+    _frameSize { 0 },
+    _channelSize { 0 }
+{}
+
+SharedResultPublisher::~SharedResultPublisher() noexcept
+{
+    Stop();
+}
+
+bool SharedResultPublisher::Start(char const* name, uint32_t numSlots) noexcept
+try
+{
+#ifdef _WIN32
+    return false;
+#else
+    std::lock_guard<std::mutex> guard { _controlLock };
+    if (IsActive())
+        return false;
+
+    size_t const numPoints { static_cast<size_t>(_width) * _height };
+    size_t const numSlotsToUse { numSlots != 0 ? numSlots : SharedResultsHeader::DefaultNumSlots };
+    size_t const pointSize { sizeof(float) + sizeof(PointType) };
+    size_t const frameSize { AlignToCacheLine(sizeof(SharedFrameHeader) + numPoints * pointSize) };
+    size_t const channelSize { sizeof(SharedChannelHeader) + numSlotsToUse * frameSize };
+    size_t const regionSize { sizeof(SharedResultsHeader) + (_numSpaces + 1) * channelSize };
+
+    // An existing object is unlinked rather than truncated, so the readers still mapping it keep
+    // it intact until they open the name again. The new object starts zeroed.
+    shm_unlink(name);
+    int const fd { shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644) };
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    void*       region { MAP_FAILED };
+    if (fstat(fd, &status) == 0 && ftruncate(fd, static_cast<off_t>(regionSize)) == 0)
+        region = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (region == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return false;
+    }
+
+    auto& header { *static_cast<SharedResultsHeader*>(region) };
+    header.version     = SharedResultsHeader::Version;
+    header.width       = _width;
+    header.height      = _height;
+    header.numSpaces   = _numSpaces;
+    header.numSlots    = static_cast<uint32_t>(numSlotsToUse);
+    header.frameSize   = frameSize;
+    header.channelSize = channelSize;
+
+    // Readers check the magic number before anything else
+    std::atomic_thread_fence(std::memory_order_release);
+    header.magic = SharedResultsHeader::Magic;
+
+    for (auto& lock : _channelLocks) lock.lock();
+    _name        = name;
+    _region      = static_cast<uint8_t*>(region);
+    _regionSize  = regionSize;
+    _device      = static_cast<uint64_t>(status.st_dev);
+    _inode       = static_cast<uint64_t>(status.st_ino);
+    _numSlots    = static_cast<uint32_t>(numSlotsToUse);
+    _frameSize   = frameSize;
+    _channelSize = channelSize;
+    for (auto& lock : _channelLocks) lock.unlock();
+
+    _active.store(true, std::memory_order_release);
+
+    return true;
+#endif
+}
+catch (...)
+{
+    return false;
+}
+
+void SharedResultPublisher::Stop() noexcept
+{
+#ifndef _WIN32
+    std::lock_guard<std::mutex> guard { _controlLock };
+    if (!IsActive())
+        return;
+
+    _active.store(false, std::memory_order_release);
+
+    // Waits for the frames being written
+    for (auto& lock : _channelLocks) lock.lock();
+    munmap(_region, _regionSize);
+
+    // Another publisher may have replaced the object since
+    if (RefersTo(_name.c_str(), _device, _inode))
+        shm_unlink(_name.c_str());
+    _region = nullptr;
+    for (auto& lock : _channelLocks) lock.unlock();
+#endif
+}
+
+void SharedResultPublisher::PublishInput(Point const* input, uint64_t generation) noexcept
+{
+    if (!IsActive())
+        return;
+
+    std::lock_guard<std::mutex> guard { _channelLocks[0] };
+    if (_region == nullptr)
+        return;
+
+    uint64_t           version;
+    SharedFrameHeader* frame { BeginFrame(0, version) };
+    frame->generation = generation;
+    frame->errorCode  = 0;
+    frame->stats      = SpaceStats {};
+
+    size_t const numPoints { static_cast<size_t>(_width) * _height };
+    auto* const  temp { reinterpret_cast<float*>(frame + 1) };
+    auto* const  type { reinterpret_cast<PointType*>(temp + numPoints) };
+    for (size_t idx { 0 }; idx < numPoints; ++idx)
+    {
+        temp[idx] = input[idx].temp;
+        type[idx] = input[idx].type;
+    }
+
+    EndFrame(0, frame, version);
+}
+
+void SharedResultPublisher::PublishResult(SpaceIndex        spaceIdx,
+                                          ErrorCode         errorCode,
+                                          uint64_t          generation,
+                                          SpaceStats const& stats,
+                                          float const*      temp) noexcept
+{
+    if (!IsActive() || spaceIdx >= _numSpaces)
+        return;
+
+    size_t const                channelIdx { static_cast<size_t>(spaceIdx) + 1 };
+    std::lock_guard<std::mutex> guard { _channelLocks[channelIdx] };
+    if (_region == nullptr)
+        return;
+
+    uint64_t           version;
+    SharedFrameHeader* frame { BeginFrame(channelIdx, version) };
+    frame->generation = generation;
+    frame->errorCode  = errorCode;
+    frame->stats      = stats;
+    std::memcpy(reinterpret_cast<float*>(frame + 1), temp, sizeof(float) * _width * _height);
+
+    EndFrame(channelIdx, frame, version);
+}
+
+SharedFrameHeader* SharedResultPublisher::BeginFrame(size_t channelIdx, uint64_t& version) noexcept
+{
+    uint8_t* const channel { _region + sizeof(SharedResultsHeader) + channelIdx * _channelSize };
+    auto&          channelHeader { *reinterpret_cast<SharedChannelHeader*>(channel) };
+
+    uint64_t const latest { channelHeader.latest.load(std::memory_order_relaxed) };
+    auto* const    frame { reinterpret_cast<SharedFrameHeader*>(
+        channel + sizeof(SharedChannelHeader) + latest % _numSlots * _frameSize) };
+
+    // Marks the slot as being written before any value of the frame changes
+    version = latest + 1;
+    frame->sequence.store(2 * version - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return frame;
+}
+
+void SharedResultPublisher::EndFrame(size_t             channelIdx,
+                                     SharedFrameHeader* frame,
+                                     uint64_t           version) noexcept
+{
+    uint8_t* const channel { _region + sizeof(SharedResultsHeader) + channelIdx * _channelSize };
+    auto&          channelHeader { *reinterpret_cast<SharedChannelHeader*>(channel) };
+
+    frame->sequence.store(2 * version, std::memory_order_release);
+    channelHeader.latest.store(version, std::memory_order_release);
+}
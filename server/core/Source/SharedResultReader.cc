@@ -0,0 +1,158 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/SharedResults.hh>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+SharedResultReader::SharedResultReader() :
+    _region { nullptr },
+    _regionSize { 0 },
+    _width { 0 },
+    _height { 0 },
+    _numSpaces { 0 },
+    _numSlots { 0 },
+    _frameSize { 0 },
+    _channelSize { 0 }
+{}
+
+SharedResultReader::~SharedResultReader() noexcept
+{
+    Close();
+}
+
+bool SharedResultReader::Open(char const* name) noexcept
+{
+#ifdef _WIN32
+    return false;
+#else
+    Close();
+
+    int const fd { shm_open(name, O_RDONLY, 0) };
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    void*       region { MAP_FAILED };
+    size_t      regionSize { 0 };
+    if (fstat(fd, &status) == 0
+        && static_cast<size_t>(status.st_size) >= sizeof(SharedResultsHeader))
+    {
+        regionSize = static_cast<size_t>(status.st_size);
+        region     = mmap(nullptr, regionSize, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (region == MAP_FAILED)
+        return false;
+
+    auto const& header { *static_cast<SharedResultsHeader const*>(region) };
+    bool        valid { header.magic == SharedResultsHeader::Magic };
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    size_t const numPoints { static_cast<size_t>(header.width) * header.height };
+    valid = valid && header.version == SharedResultsHeader::Version && header.numSlots != 0
+            && header.frameSize
+                   >= sizeof(SharedFrameHeader) + numPoints * (sizeof(float) + sizeof(PointType))
+            && header.channelSize
+                   >= sizeof(SharedChannelHeader) + header.numSlots * header.frameSize
+            && regionSize
+                   >= sizeof(SharedResultsHeader)
+                          + (static_cast<size_t>(header.numSpaces) + 1) * header.channelSize;
+    if (!valid)
+    {
+        munmap(region, regionSize);
+        return false;
+    }
+
+    _region      = static_cast<uint8_t const*>(region);
+    _regionSize  = regionSize;
+    _width       = header.width;
+    _height      = header.height;
+    _numSpaces   = header.numSpaces;
+    _numSlots    = header.numSlots;
+    _frameSize   = header.frameSize;
+    _channelSize = header.channelSize;
+
+    return true;
+#endif
+}
+
+void SharedResultReader::Close() noexcept
+{
+#ifndef _WIN32
+    if (_region == nullptr)
+        return;
+
+    munmap(const_cast<uint8_t*>(_region), _regionSize);
+    _region = nullptr;
+#endif
+}
+
+bool SharedResultReader::AcquireInput(SharedResultView& view) const noexcept
+{
+    if (!Acquire(0, view))
+        return false;
+
+    size_t const numPoints { static_cast<size_t>(_width) * _height };
+    view.type = reinterpret_cast<PointType const*>(view.temp + numPoints);
+    return true;
+}
+
+bool SharedResultReader::AcquireResult(SpaceIndex spaceIdx, SharedResultView& view) const noexcept
+{
+    if (spaceIdx >= _numSpaces)
+        return false;
+
+    return Acquire(static_cast<size_t>(spaceIdx) + 1, view);
+}
+
+bool SharedResultReader::IsValid(SharedResultView const& view) const noexcept
+{
+    // Orders the reads of the values before the check of the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.frame->sequence.load(std::memory_order_relaxed) == 2 * view.version;
+}
+
+bool SharedResultReader::Acquire(size_t channelIdx, SharedResultView& view) const noexcept
+{
+    if (_region == nullptr)
+        return false;
+
+    uint8_t const* const channel {
+        _region + sizeof(SharedResultsHeader) + channelIdx * _channelSize,
+    };
+    auto const& channelHeader { *reinterpret_cast<SharedChannelHeader const*>(channel) };
+
+    // The latest frame is only overwritten after the publisher goes around the ring, so a retry
+    // fails only if the reader is preempted for that long.
+    for (int attempt { 0 }; attempt < 4; ++attempt)
+    {
+        uint64_t const version { channelHeader.latest.load(std::memory_order_acquire) };
+        if (version == 0)
+            return false;
+
+        auto const* const frame { reinterpret_cast<SharedFrameHeader const*>(
+            channel + sizeof(SharedChannelHeader) + (version - 1) % _numSlots * _frameSize) };
+        if (frame->sequence.load(std::memory_order_acquire) != 2 * version)
+            continue;
+
+        view.version    = version;
+        view.generation = frame->generation;
+        view.errorCode  = frame->errorCode;
+        view.stats      = frame->stats;
+        view.temp       = reinterpret_cast<float const*>(frame + 1);
+        view.type       = nullptr;
+        view.frame      = frame;
+
+        if (IsValid(view))
+            return true;
+    }
+
+    return false;
+}
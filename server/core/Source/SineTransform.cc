@@ -0,0 +1,72 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/SineTransform.hh>
+
+#include <cmath>
+
+namespace
+{
+
+constexpr double pi { 3.14159265358979323846 };
+
+}
+
+SineTransform::SineTransform(size_t length) :
+    _length { length },
+    _fft { length + 1 },
+    _sines(length + 1),
+    _buffer(length + 1)
+{
+    for (size_t j { 0 }; j <= length; ++j)
+        _sines[j] = std::sin(pi * static_cast<double>(j) / static_cast<double>(length + 1));
+}
+
+void SineTransform::Transform(double* first, double* second) noexcept
+{
+    // With N = n + 1 and f_0 = 0, the sequence y_j = sin(πj / N) (f_j + f_N-j) + (f_j - f_N-j) / 2
+    // has a Fourier transform R_k - i I_k where I_k is the 2k-th term of the sine transform and
+    // R_k the difference of the (2k + 1)-th and the (2k - 1)-th, as in `sinft` of Numerical
+    // Recipes. The sequences of both inputs are transformed at once.
+    size_t const n { _length };
+    size_t const fftLength { n + 1 };
+
+    _buffer[0] = Fft::Complex { 0.0, 0.0 };
+    for (size_t j { 1 }; j <= n; ++j)
+    {
+        double const a { first[j - 1] }, aMirror { first[n - j] };
+        double const b { second != nullptr ? second[j - 1] : 0.0 };
+        double const bMirror { second != nullptr ? second[n - j] : 0.0 };
+
+        _buffer[j] = Fft::Complex { _sines[j] * (a + aMirror) + 0.5 * (a - aMirror),
+                                    _sines[j] * (b + bMirror) + 0.5 * (b - bMirror) };
+    }
+
+    _fft.Transform(_buffer.data());
+
+    double oddFirst { 0.0 }, oddSecond { 0.0 };
+    for (size_t k { 0 }; 2 * k <= n; ++k)
+    {
+        // Separates the transforms of the real and the imaginary part
+        Fft::Complex const z { _buffer[k] };
+        Fft::Complex const mirror { std::conj(_buffer[k == 0 ? 0 : fftLength - k]) };
+        Fft::Complex const sum { z + mirror }, difference { z - mirror };
+
+        if (k != 0)
+        {
+            first[2 * k - 1] = -0.5 * sum.imag();
+            if (second != nullptr)
+                second[2 * k - 1] = 0.5 * difference.real();
+        }
+
+        if (2 * k + 1 <= n)
+        {
+            double const realFirst { 0.5 * sum.real() }, realSecond { 0.5 * difference.imag() };
+            oddFirst     = k == 0 ? 0.5 * realFirst : oddFirst + realFirst;
+            oddSecond    = k == 0 ? 0.5 * realSecond : oddSecond + realSecond;
+            first[2 * k] = oddFirst;
+            if (second != nullptr)
+                second[2 * k] = oddSecond;
+        }
+    }
+}
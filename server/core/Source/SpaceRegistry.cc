@@ -0,0 +1,22 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/SpaceRegistry.hh>
+
+#include <cstring>
+
+std::unique_ptr<Space> SpaceRegistry::Create(uint16_t           width,
+                                             uint16_t           height,
+                                             SpaceConfig const& config) const
+{
+    if (config.name == nullptr)
+        return nullptr;
+
+    for (auto& entry : _entries)
+    {
+        if (std::strcmp(entry.name, config.name) == 0)
+            return entry.factory(width, height, config);
+    }
+
+    return nullptr;
+}
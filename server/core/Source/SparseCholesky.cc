@@ -0,0 +1,204 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/SparseCholesky.hh>
+
+#include <algorithm>
+#include <cmath>
+
+// The symbolic and the numeric phases follow the up-looking LDLᵀ factorization of T. A. Davis,
+// "Algorithm 849: A Concise Sparse Cholesky Factorization Package". Row k of L is found by walking
+// the elimination tree from the nonzeros of row k of A.
+
+namespace
+{
+
+constexpr double pivotTolerance { 1e-10 };
+
+}
+
+bool SparseCholesky::Factorize(SparseMatrix const& A, std::vector<uint32_t> const& order)
+{
+    Clear();
+
+    size_t const n { A.size() };
+    if (order.size() != n)
+        return false;
+
+    _order = order;
+    _orderInv.resize(n);
+    for (size_t k { 0 }; k < n; ++k) _orderInv[_order[k]] = static_cast<uint32_t>(k);
+
+    // Builds the elimination tree and counts the nonzeros of each column of L
+    std::vector<int32_t> flags(n);
+    std::vector<size_t>  counts(n, 0);
+    _parent.assign(n, -1);
+    for (size_t k { 0 }; k < n; ++k)
+    {
+        flags[k] = static_cast<int32_t>(k);
+
+        uint32_t const row { _order[k] };
+        for (uint32_t p { A.rowStarts[row] }, pEnd { A.rowStarts[row + 1] }; p < pEnd; ++p)
+        {
+            for (int32_t i { static_cast<int32_t>(_orderInv[A.columns[p]]) };
+                 i < static_cast<int32_t>(k) && flags[i] != static_cast<int32_t>(k);
+                 i = _parent[i])
+            {
+                if (_parent[i] == -1)
+                    _parent[i] = static_cast<int32_t>(k);
+
+                ++counts[i];
+                flags[i] = static_cast<int32_t>(k);
+            }
+        }
+    }
+
+    _columnStarts.resize(n + 1);
+    _columnStarts[0] = 0;
+    for (size_t k { 0 }; k < n; ++k) _columnStarts[k + 1] = _columnStarts[k] + counts[k];
+
+    _rows.resize(_columnStarts[n]);
+    _values.resize(_columnStarts[n]);
+    _diagonal.resize(n);
+
+    // Computes the rows of L one by one, scattering row k of A into `y`
+    std::vector<double>   y(n, 0.0);
+    std::vector<uint32_t> pattern(n);
+    std::fill(counts.begin(), counts.end(), 0);
+    for (size_t k { 0 }; k < n; ++k)
+    {
+        flags[k] = static_cast<int32_t>(k);
+
+        size_t         top { n };
+        uint32_t const row { _order[k] };
+        for (uint32_t p { A.rowStarts[row] }, pEnd { A.rowStarts[row + 1] }; p < pEnd; ++p)
+        {
+            int32_t i { static_cast<int32_t>(_orderInv[A.columns[p]]) };
+            if (i > static_cast<int32_t>(k))
+                continue;
+
+            y[i] += A.values[p];
+
+            size_t length { 0 };
+            for (; flags[i] != static_cast<int32_t>(k); i = _parent[i])
+            {
+                pattern[length++] = static_cast<uint32_t>(i);
+                flags[i]          = static_cast<int32_t>(k);
+            }
+            while (length > 0) pattern[--top] = pattern[--length];
+        }
+
+        double const a { A.diagonal[row] };
+        double       d { a };
+        for (; top < n; ++top)
+        {
+            uint32_t const i { pattern[top] };
+            double const   yi { y[i] };
+            y[i] = 0.0;
+
+            size_t const pEnd { _columnStarts[i] + counts[i] };
+            for (size_t p { _columnStarts[i] }; p < pEnd; ++p) y[_rows[p]] -= _values[p] * yi;
+
+            double const lki { yi / _diagonal[i] };
+            d -= lki * yi;
+
+            _rows[pEnd]   = static_cast<uint32_t>(k);
+            _values[pEnd] = lki;
+            ++counts[i];
+        }
+
+        // A definite matrix keeps the sign of its diagonal in every pivot
+        if (!std::isfinite(d) || !(d * a > 0.0) || std::abs(d) < pivotTolerance * std::abs(a))
+        {
+            Clear();
+            return false;
+        }
+
+        _diagonal[k] = d;
+    }
+
+    return true;
+}
+
+void SparseCholesky::Solve(float const* b, float* x, double* work) const noexcept
+{
+    size_t const n { size() };
+    for (size_t k { 0 }; k < n; ++k) work[k] = b[_order[k]];
+
+    for (size_t j { 0 }; j < n; ++j)
+    {
+        double const wj { work[j] };
+        for (size_t p { _columnStarts[j] }, pEnd { _columnStarts[j + 1] }; p < pEnd; ++p)
+            work[_rows[p]] -= _values[p] * wj;
+    }
+
+    for (size_t j { 0 }; j < n; ++j) work[j] /= _diagonal[j];
+
+    for (size_t j { n }; j-- > 0;)
+    {
+        double wj { work[j] };
+        for (size_t p { _columnStarts[j] }, pEnd { _columnStarts[j + 1] }; p < pEnd; ++p)
+            wj -= _values[p] * work[_rows[p]];
+        work[j] = wj;
+    }
+
+    for (size_t k { 0 }; k < n; ++k) x[_order[k]] = static_cast<float>(work[k]);
+}
+
+void SparseCholesky::Solve(float const* b, float* x, size_t numRhs, double* work) const noexcept
+{
+    // The right-hand sides are interleaved in `work`, so every entry of L is applied to all of
+    // them from one cache line.
+    size_t const n { size() };
+    for (size_t k { 0 }; k < n; ++k)
+    {
+        double* wk { work + k * numRhs };
+        for (size_t r { 0 }; r < numRhs; ++r) wk[r] = b[r * n + _order[k]];
+    }
+
+    for (size_t j { 0 }; j < n; ++j)
+    {
+        double const* wj { work + j * numRhs };
+        for (size_t p { _columnStarts[j] }, pEnd { _columnStarts[j + 1] }; p < pEnd; ++p)
+        {
+            double*      wi { work + _rows[p] * numRhs };
+            double const l { _values[p] };
+            for (size_t r { 0 }; r < numRhs; ++r) wi[r] -= l * wj[r];
+        }
+    }
+
+    for (size_t j { 0 }; j < n; ++j)
+    {
+        double*      wj { work + j * numRhs };
+        double const d { _diagonal[j] };
+        for (size_t r { 0 }; r < numRhs; ++r) wj[r] /= d;
+    }
+
+    for (size_t j { n }; j-- > 0;)
+    {
+        double* wj { work + j * numRhs };
+        for (size_t p { _columnStarts[j] }, pEnd { _columnStarts[j + 1] }; p < pEnd; ++p)
+        {
+            double const* wi { work + _rows[p] * numRhs };
+            double const  l { _values[p] };
+            for (size_t r { 0 }; r < numRhs; ++r) wj[r] -= l * wi[r];
+        }
+    }
+
+    for (size_t k { 0 }; k < n; ++k)
+    {
+        double const* wk { work + k * numRhs };
+        for (size_t r { 0 }; r < numRhs; ++r) x[r * n + _order[k]] = static_cast<float>(wk[r]);
+    }
+}
+
+void SparseCholesky::Clear() noexcept
+{
+    _order.clear();
+    _orderInv.clear();
+    _parent.clear();
+    _columnStarts.clear();
+    _rows.clear();
+    _values.clear();
+    _diagonal.clear();
+}
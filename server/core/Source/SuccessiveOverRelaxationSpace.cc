@@ -3,43 +3,376 @@
 
 #include <leth/SuccessiveOverRelaxationSpace.hh>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
-#include <cstdio>
+#include <limits>
+
+namespace
+{
+
+constexpr float    defaultTolerance { 0.001f };
+constexpr uint32_t defaultMaxIterations { 10000 };
+
+constexpr uint32_t numEstimationSweeps { 20 };
+constexpr uint32_t rateWindow { 8 };
+constexpr float    rateFloor { 10.0f };
+constexpr size_t   maxCachedTopologies { 256 };
+constexpr float    maxJacobiRadius { 0.99999f };
+constexpr float    maxOmega { 1.99f };
+constexpr uint16_t minChainedCoarseSize { 16 };
+
+/// Returns the optimal relaxation factor for a consistently ordered matrix whose Jacobi iteration
+/// has the given spectral radius.
+float GetOptimalOmega(float jacobiRadius) noexcept
+{
+    float const omega { 2.0f / (1.0f + std::sqrt(1.0f - jacobiRadius * jacobiRadius)) };
+    return std::min(std::max(omega, 1.0f), maxOmega);
+}
+
+/// Returns the average contraction per sweep of a change `from` into a change `to` after
+/// `numSweeps` sweeps, or 0 if it cannot be measured.
+float GetConvergenceRate(float from, float to, size_t numSweeps) noexcept
+{
+    if (numSweeps == 0 || from <= 0.0f || to <= 0.0f)
+        return 0.0f;
+
+    return std::pow(to / from, 1.0f / static_cast<float>(numSweeps));
+}
+
+}
+
+SuccessiveOverRelaxationSpace::SuccessiveOverRelaxationSpace(uint16_t           width,
+                                                             uint16_t           height,
+                                                             SpaceConfig const& config) :
+    MatrixSpace { width, height, config },
+    _omega { config.omega },
+    _tolerance { config.tolerance > 0.0f ? config.tolerance : defaultTolerance },
+    _maxIterations { config.maxIterations != 0 ? config.maxIterations : defaultMaxIterations },
+    _converged { true },
+    _previewScale { config.previewScale },
+    _previewLevel { 0 }
+{
+    if (_previewScale != 2 && _previewScale != 4 && _previewScale != 8)
+        return;
+
+    while ((1u << _previewLevel) < _previewScale) ++_previewLevel;
+
+    uint16_t const coarseWidth {
+        static_cast<uint16_t>((width + _previewScale - 1) / _previewScale)
+    };
+    uint16_t const coarseHeight {
+        static_cast<uint16_t>((height + _previewScale - 1) / _previewScale)
+    };
+
+    // Coarse grids that are still large start from a preview of their own
+    SpaceConfig coarseConfig { config };
+    coarseConfig.previewScale = std::min(coarseWidth, coarseHeight) >= minChainedCoarseSize ? 2 : 0;
+    _coarseSpace = std::make_unique<SuccessiveOverRelaxationSpace>(coarseWidth,
+                                                                   coarseHeight,
+                                                                   coarseConfig);
+    _coarseInput.resize(static_cast<size_t>(coarseWidth) * coarseHeight);
+    _coarseOutput.resize(static_cast<size_t>(coarseWidth) * coarseHeight);
+}
 
 char const* SuccessiveOverRelaxationSpace::GetName() noexcept
 {
     return "SOR";
 }
 
-void SuccessiveOverRelaxationSpace::SolveEquation(std::vector<float> const& A,
+bool SuccessiveOverRelaxationSpace::HasConverged() noexcept
+{
+    return _converged;
+}
+
+bool SuccessiveOverRelaxationSpace::SolveEquation(SparseMatrix const&       A,
                                                   std::vector<float>&       x,
                                                   std::vector<float> const& b) noexcept
 {
-    constexpr float omega { 1.12f };
-
     size_t const numVars { x.size() };
-    for (size_t iter { 0 }; iter < 10000; ++iter)
+    uint32_t     numIterations { 0 };
+    float        omega { _omega };
+    float*       jacobiRadius { nullptr };
+
+    _converged = true;
+    if (numVars == 0)
+        return true;
+
+    if (_omega <= 0.0f)
     {
-        bool converge { true };
-        for (size_t i { 0 }; i < numVars; ++i)
+        uint32_t   numColumns, numRows;
+        bool const rectangular { IsRectangular(numColumns, numRows) };
+
+        float* radius { FindJacobiRadius() };
+        if (radius == nullptr)
         {
-            float const before { x[i] };
+            float estimate;
+            if (rectangular)
+            {
+                float const pi { 3.14159265358979f };
+                estimate = 0.5f
+                           * (std::cos(pi / static_cast<float>(numColumns + 1))
+                              + std::cos(pi / static_cast<float>(numRows + 1)));
+            }
+            else
+                estimate = EstimateJacobiRadius(A, x, b, numIterations);
 
-            x[i] = b[i];
+            // Falls back to an uncached estimate
+            radius = CacheJacobiRadius(estimate);
 
-            for (size_t j { 0 }; j < i; ++j) x[i] -= (A[i * numVars + j] * x[j]);
+            omega = GetOptimalOmega(estimate);
+        }
 
-            for (size_t j { i + 1 }; j < numVars; ++j) x[i] -= (A[i * numVars + j] * x[j]);
+        if (radius != nullptr)
+        {
+            // The radius of a rectangle is exact and needs no refinement
+            jacobiRadius = rectangular ? nullptr : radius;
+            omega        = GetOptimalOmega(*radius);
+        }
+    }
 
-            x[i] *= omega;
-            x[i] /= A[i * numVars + i];
-            x[i] += (1 - omega) * before;
+    // The largest changes of the last sweeps, to measure the convergence rate
+    std::array<float, rateWindow + 1> deltas {};
+    size_t                            numSweeps { 0 };
+    float                             delta { std::numeric_limits<float>::infinity() };
+    while (numIterations < _maxIterations)
+    {
+        delta = Sweep(A, x, b, omega);
+        ++numIterations;
+
+        if (delta < _tolerance)
+            break;
 
-            if (std::abs(x[i] - before) >= 0.001)
-                converge = false;
+        // The last sweeps are dominated by rounding errors
+        if (delta >= rateFloor * _tolerance)
+            deltas[numSweeps++ % deltas.size()] = delta;
+    }
+
+    // With omega below the optimum, the error contracts by r per sweep where
+    // r + omega - 1 = omega * mu * sqrt(r), and mu is the Jacobi radius. Near and above the
+    // optimum r approaches omega - 1 and the measured rate is skewed by the non-normal modes, so
+    // only rates clearly slower than that raise the estimate.
+    if (jacobiRadius != nullptr && numSweeps > 2 * rateWindow)
+    {
+        float const rate { GetConvergenceRate(deltas[numSweeps % deltas.size()],
+                                              deltas[(numSweeps - 1) % deltas.size()],
+                                              rateWindow) };
+        if (rate > std::sqrt(omega - 1.0f) && rate < 1.0f)
+        {
+            float const observed { (rate + omega - 1.0f) / (omega * std::sqrt(rate)) };
+            if (std::isfinite(observed) && observed > *jacobiRadius)
+                *jacobiRadius = std::min(0.5f * (*jacobiRadius + observed), maxJacobiRadius);
         }
+    }
+
+    // The next simulation of the same input continues from where this one stopped
+    _converged = delta < _tolerance;
+
+    stats().numIterations = numIterations;
+    stats().omega         = omega;
+
+    return true;
+}
+
+float SuccessiveOverRelaxationSpace::Sweep(SparseMatrix const&       A,
+                                           std::vector<float>&       x,
+                                           std::vector<float> const& b,
+                                           float                     omega) noexcept
+{
+    size_t const numVars { x.size() };
+    float        maxDelta { 0.0f };
+    for (size_t i { 0 }; i < numVars; ++i)
+    {
+        float const before { x[i] };
+
+        float sum { b[i] };
+        for (uint32_t k { A.rowStarts[i] }, kEnd { A.rowStarts[i + 1] }; k < kEnd; ++k)
+            sum -= A.values[k] * x[A.columns[k]];
+
+        x[i] = omega * sum / A.diagonal[i] + (1 - omega) * before;
+
+        maxDelta = std::max(maxDelta, std::abs(x[i] - before));
+    }
+
+    return maxDelta;
+}
 
-        if (converge)
+float SuccessiveOverRelaxationSpace::EstimateJacobiRadius(SparseMatrix const&       A,
+                                                          std::vector<float>&       x,
+                                                          std::vector<float> const& b,
+                                                          uint32_t& numIterations) noexcept
+{
+    // Gauss-Seidel contracts the error by the square of the Jacobi radius per sweep. The sweeps
+    // also advance the solution, so none of them is wasted.
+    std::array<float, numEstimationSweeps + 1> deltas {};
+
+    size_t numSweeps { 0 };
+    for (; numSweeps < deltas.size() && numIterations < _maxIterations; ++numSweeps)
+    {
+        deltas[numSweeps] = Sweep(A, x, b, 1.0f);
+        ++numIterations;
+
+        if (deltas[numSweeps] < _tolerance)
+        {
+            ++numSweeps;
             break;
+        }
+    }
+
+    // Skips the first half, where the faster modes are still decaying
+    size_t const from { numSweeps / 2 };
+    size_t const to { numSweeps - 1 };
+    float const  rate {
+        numSweeps < 4 ? 0.0f : GetConvergenceRate(deltas[from], deltas[to], to - from),
+    };
+    return std::min(std::sqrt(rate), maxJacobiRadius);
+}
+
+float* SuccessiveOverRelaxationSpace::FindJacobiRadius() noexcept
+{
+    // Different topologies may share a hash
+    auto const it { _jacobiRadii.find(topologyHash()) };
+    if (it == _jacobiRadii.end() || it->second.pointTypes != pointTypes())
+        return nullptr;
+
+    return &it->second.radius;
+}
+
+float* SuccessiveOverRelaxationSpace::CacheJacobiRadius(float radius) noexcept
+try
+{
+    if (_jacobiRadii.size() >= maxCachedTopologies)
+        _jacobiRadii.clear();
+
+    // Replaces the radius of another topology with the same hash
+    auto& cached { _jacobiRadii[topologyHash()] };
+    cached = CachedJacobiRadius { pointTypes(), radius };
+    return &cached.radius;
+}
+catch (...)
+{
+    return nullptr;
+}
+
+void SuccessiveOverRelaxationSpace::GuessSolution(Point const*        input,
+                                                  float*              output,
+                                                  std::vector<float>& x) noexcept
+{
+    if (_coarseSpace == nullptr)
+        return;
+
+    BuildCoarseInput(input);
+    _coarseSpace->stats() = SpaceStats {};
+    if (_coarseSpace->RunSimulation(_coarseInput.data(), _coarseOutput.data()) != 0)
+        return;
+
+    for (uint16_t i { 0 }, iEnd { height() }; i < iEnd; ++i)
+    {
+        for (uint16_t j { 0 }, jEnd { width() }; j < jEnd; ++j)
+        {
+            size_t const idx { GetIndex(i, j) };
+            switch (input[idx].type)
+            {
+            case PointType::Boundary: output[idx] = input[idx].temp; break;
+            case PointType::OutOfRange: output[idx] = 0.0f; break;
+            default: output[idx] = InterpolateCoarseOutput(i, j); break;
+            }
+        }
     }
+
+    stats().numIterations = _coarseSpace->stats().numIterations;
+    stats().omega         = _coarseSpace->stats().omega;
+    PublishPreview(output, _previewLevel);
+
+    // The smoothest error decays as 1 - mu ~ h², so the Jacobi radius of the coarse grid predicts
+    // the radius of this one. Estimating it here would fail, as the guess leaves little to sweep.
+    uint32_t     numColumns, numRows;
+    float const* coarse { _coarseSpace->FindJacobiRadius() };
+    if (_omega <= 0.0f && !IsRectangular(numColumns, numRows) && FindJacobiRadius() == nullptr
+        && coarse != nullptr)
+    {
+        float const scale { static_cast<float>(_previewScale) };
+        CacheJacobiRadius(std::min(1.0f - (1.0f - *coarse) / (scale * scale), maxJacobiRadius));
+    }
+
+    auto const& pos { positions() };
+    for (size_t i { 0 }, iEnd { pos.size() }; i < iEnd; ++i)
+        x[i] = output[GetIndex(pos[i].y, pos[i].x)];
+}
+
+void SuccessiveOverRelaxationSpace::BuildCoarseInput(Point const* input) noexcept
+{
+    size_t const coarseWidth { _coarseSpace->width() };
+    size_t const coarseHeight { _coarseSpace->height() };
+    for (size_t ci { 0 }; ci < coarseHeight; ++ci)
+    {
+        for (size_t cj { 0 }; cj < coarseWidth; ++cj)
+        {
+            uint32_t numBoundaries { 0 };
+            float    sum { 0.0f };
+            bool     hasUnknown { false };
+
+            size_t const iEnd { std::min<size_t>(height(), (ci + 1) * _previewScale) };
+            size_t const jEnd { std::min<size_t>(width(), (cj + 1) * _previewScale) };
+            for (size_t i { ci * _previewScale }; i < iEnd; ++i)
+            {
+                for (size_t j { cj * _previewScale }; j < jEnd; ++j)
+                {
+                    Point const& point { input[i * width() + j] };
+                    if (point.type == PointType::Boundary)
+                    {
+                        ++numBoundaries;
+                        sum += point.temp;
+                    }
+                    else if (point.type == PointType::GroundTruth)
+                        hasUnknown = true;
+                }
+            }
+
+            Point& coarse { _coarseInput[ci * coarseWidth + cj] };
+            if (numBoundaries != 0)
+                coarse = Point { PointType::Boundary, sum / static_cast<float>(numBoundaries) };
+            else if (hasUnknown)
+                coarse = Point { PointType::GroundTruth, 0.0f };
+            else
+                coarse = Point { PointType::OutOfRange, 0.0f };
+        }
+    }
+}
+
+float SuccessiveOverRelaxationSpace::InterpolateCoarseOutput(uint16_t i, uint16_t j) const noexcept
+{
+    int32_t const coarseWidth { _coarseSpace->width() };
+    int32_t const coarseHeight { _coarseSpace->height() };
+    float const   scale { static_cast<float>(_previewScale) };
+
+    // Coordinates on the coarse grid, where the coarse points lie at integers
+    float const   u { (static_cast<float>(i) + 0.5f) / scale - 0.5f };
+    float const   v { (static_cast<float>(j) + 0.5f) / scale - 0.5f };
+    int32_t const i0 { static_cast<int32_t>(std::floor(u)) };
+    int32_t const j0 { static_cast<int32_t>(std::floor(v)) };
+    float const   tu { u - static_cast<float>(i0) };
+    float const   tv { v - static_cast<float>(j0) };
+
+    float sum { 0.0f }, weightSum { 0.0f };
+    for (int32_t di { 0 }; di < 2; ++di)
+    {
+        for (int32_t dj { 0 }; dj < 2; ++dj)
+        {
+            int32_t const ci { i0 + di }, cj { j0 + dj };
+            if (ci < 0 || ci >= coarseHeight || cj < 0 || cj >= coarseWidth)
+                continue;
+
+            size_t const idx { static_cast<size_t>(ci) * coarseWidth + cj };
+            if (_coarseInput[idx].type == PointType::OutOfRange)
+                continue;
+
+            float const weight { (di != 0 ? tu : 1.0f - tu) * (dj != 0 ? tv : 1.0f - tv) };
+            sum += weight * _coarseOutput[idx];
+            weightSum += weight;
+        }
+    }
+
+    // The coarse point covering (i, j) always has a positive weight
+    return weightSum > 0.0f ? sum / weightSum : 0.0f;
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/ThreadPolicy.hh>
+
+#ifdef __linux__
+#    include <sched.h>
+#    include <sys/resource.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+bool ApplyThreadPolicy(ThreadPolicy const& policy) noexcept
+{
+#ifdef __linux__
+    bool succeeded { true };
+
+    if (policy.cpuMask != 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu { 0 }; cpu < 64; ++cpu)
+        {
+            if ((policy.cpuMask >> cpu & 1) != 0)
+                CPU_SET(cpu, &cpus);
+        }
+
+        // Zero is the calling thread, not the whole process
+        succeeded = sched_setaffinity(0, sizeof(cpus), &cpus) == 0 && succeeded;
+    }
+
+    if (policy.batch)
+    {
+        sched_param param {};
+        succeeded = sched_setscheduler(0, SCHED_BATCH, &param) == 0 && succeeded;
+    }
+
+    // The nice value of a Linux thread is set through its thread ID
+    if (policy.nice != 0)
+    {
+        auto const tid { static_cast<id_t>(syscall(SYS_gettid)) };
+        succeeded = setpriority(PRIO_PROCESS, tid, policy.nice) == 0 && succeeded;
+    }
+
+    return succeeded;
+#else
+    return policy.cpuMask == 0 && policy.nice == 0 && !policy.batch;
+#endif
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <leth/WorkerPool.hh>
+
+WorkerPool::WorkerPool(uint32_t numThreads) :
+    _epoch { 0 },
+    _numBusy { 0 },
+    _stopped { false },
+    _policy {},
+    _policyEpoch { 0 },
+    _task { nullptr },
+    _context { nullptr },
+    _next { 0 },
+    _end { 0 }
+{
+    for (uint32_t workerIdx { 1 }; workerIdx < numThreads; ++workerIdx)
+        _threads.push_back(std::thread { &WorkerPool::Work, this, workerIdx });
+}
+
+WorkerPool::~WorkerPool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> guard { _lock };
+        _stopped = true;
+    }
+    _wake.notify_all();
+    for (auto& thread : _threads) thread.join();
+}
+
+void WorkerPool::SetThreadPolicy(ThreadPolicy const& policy) noexcept
+{
+    std::lock_guard<std::mutex> guard { _lock };
+    _policy = policy;
+    ++_policyEpoch;
+}
+
+void WorkerPool::Run(size_t begin, size_t end, Task task, void* context) noexcept
+{
+    {
+        std::lock_guard<std::mutex> guard { _lock };
+        _task    = task;
+        _context = context;
+        _end     = end;
+        _numBusy = static_cast<uint32_t>(_threads.size());
+        _next.store(begin, std::memory_order_relaxed);
+        ++_epoch;
+    }
+    _wake.notify_all();
+
+    RunTasks(0);
+
+    std::unique_lock<std::mutex> lock { _lock };
+    _done.wait(lock, [this] { return _numBusy == 0; });
+}
+
+void WorkerPool::Work(uint32_t workerIdx) noexcept
+{
+    uint64_t epoch { 0 }, policyEpoch { 0 };
+    while (true)
+    {
+        ThreadPolicy policy;
+        bool         policyChanged;
+        {
+            std::unique_lock<std::mutex> lock { _lock };
+            _wake.wait(lock, [this, epoch] { return _stopped || _epoch != epoch; });
+            if (_stopped)
+                return;
+
+            epoch         = _epoch;
+            policy        = _policy;
+            policyChanged = policyEpoch != _policyEpoch;
+            policyEpoch   = _policyEpoch;
+        }
+
+        if (policyChanged)
+            ApplyThreadPolicy(policy);
+
+        RunTasks(workerIdx);
+
+        {
+            std::lock_guard<std::mutex> guard { _lock };
+            if (--_numBusy == 0)
+                _done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::RunTasks(uint32_t workerIdx) noexcept
+{
+    for (size_t idx { _next.fetch_add(1, std::memory_order_relaxed) }; idx < _end;
+         idx = _next.fetch_add(1, std::memory_order_relaxed))
+        _task(_context, idx, workerIdx);
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include "TestPlate.hh"
+
+#include <gtest/gtest.h>
+#include <leth/BoundaryInfluenceSpace.hh>
+#include <leth/CholeskySpace.hh>
+#include <leth/FastPoissonSpace.hh>
+#include <leth/Lib.hh>
+#include <leth/MonteCarloSpace.hh>
+#include <leth/SuccessiveOverRelaxationSpace.hh>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Counts every allocation of the process, so the tests can tell whether a steady state allocates
+namespace
+{
+
+std::atomic<size_t> numAllocations { 0 };
+
+}
+
+void* operator new(size_t size)
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr { std::malloc(size != 0 ? size : 1) })
+        return ptr;
+
+    throw std::bad_alloc {};
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+
+constexpr uint16_t width { 24 }, height { 16 };
+
+/// Runs a space until its buffers are sized, then returns the number of allocations made by
+/// runs with changing temperatures.
+template <typename SpaceT>
+size_t CountSteadyStateAllocations(SpaceConfig const& config)
+{
+    TestSpace<SpaceT>  space { width, height, config };
+    std::vector<float> output(width * height);
+
+    std::vector<std::vector<Point>> inputs;
+    for (int k { 0 }; k < 4; ++k)
+    {
+        float const temp { 10.0f * k };
+        inputs.push_back(MakePlate(width, height, true, [=](uint16_t, uint16_t) { return temp; }));
+    }
+
+    for (auto& input : inputs) EXPECT_EQ(space.RunSimulation(input.data(), output.data()), 0);
+
+    size_t const before { numAllocations.load() };
+    for (int round { 0 }; round < 3; ++round)
+    {
+        for (auto& input : inputs) space.RunSimulation(input.data(), output.data());
+    }
+    return numAllocations.load() - before;
+}
+
+}
+
+TEST(AllocationTest, SpacesDoNotAllocateInSteadyState)
+{
+    SpaceConfig config {};
+    config.numThreads = 2;
+    config.numWalks   = 64;
+
+    EXPECT_EQ(CountSteadyStateAllocations<SuccessiveOverRelaxationSpace>(config), 0);
+    EXPECT_EQ(CountSteadyStateAllocations<CholeskySpace>(config), 0);
+    EXPECT_EQ(CountSteadyStateAllocations<BoundaryInfluenceSpace>(config), 0);
+    EXPECT_EQ(CountSteadyStateAllocations<FastPoissonSpace>(config), 0);
+    EXPECT_EQ(CountSteadyStateAllocations<MonteCarloSpace>(config), 0);
+}
+
+TEST(AllocationTest, ServerDoesNotAllocateWhileSolving)
+{
+    SpaceConfig spaces[1] {};
+    spaces[0].name = "SuccessiveOverRelaxationSpace";
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = spaces;
+    config.numSpaces = 1;
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    for (uint16_t x { 0 }; x < width; ++x) leth_set(server, x, 0, 100.0f, PointType::Boundary);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    size_t const before { numAllocations.load() };
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(numAllocations.load() - before, 0);
+
+    leth_delete(server);
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include "TestPlate.hh"
+
+#include <gtest/gtest.h>
+#include <leth/CholeskySpace.hh>
+#include <leth/Lib.hh>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr uint16_t width { 24 }, height { 18 };
+
+/// Returns the point types of an L-shaped plate whose rim is a boundary.
+std::vector<PointType> MakeTypes()
+{
+    std::vector<PointType> type;
+    for (auto& point : MakePlate(width, height, true, [](uint16_t, uint16_t) { return 0.0f; }))
+        type.push_back(point.type);
+    return type;
+}
+
+}
+
+TEST(BatchSolveTest, MatchesSingleSolves)
+{
+    std::vector<PointType> const type { MakeTypes() };
+
+    SpaceConfig spaces[2] {};
+    spaces[0].name = "MonteCarloSpace";
+    spaces[1].name = "CholeskySpace";
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = spaces;
+    config.numSpaces = 2;
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    // Not a multiple of the block size, so the last block is partial
+    uint32_t const                        numScenarios { 19 };
+    std::mt19937                          engine { 0 };
+    std::uniform_real_distribution<float> distribution { 0.0f, 100.0f };
+    std::vector<float>                    temps(numScenarios * width * height);
+    for (auto& temp : temps) temp = distribution(engine);
+
+    std::vector<float> results(temps.size());
+    ErrorCode const errorCode {
+        leth_solve_batch(server, 1, type.data(), temps.data(), numScenarios, results.data(), 3),
+    };
+    EXPECT_EQ(errorCode, 0);
+    EXPECT_EQ(leth_solve_batch(server, 0, type.data(), temps.data(), 1, results.data(), 1),
+              BatchNotSupportedError);
+    EXPECT_EQ(leth_solve_batch(server, 2, type.data(), temps.data(), 1, results.data(), 1),
+              InvalidSpaceIndexError);
+    leth_delete(server);
+
+    TestSpace<CholeskySpace> space { width, height };
+    std::vector<Point>       input(width * height);
+    std::vector<float>       output(width * height);
+    for (uint32_t k { 0 }; k < numScenarios; ++k)
+    {
+        for (size_t idx { 0 }; idx < input.size(); ++idx)
+            input[idx] = Point { type[idx], temps[k * input.size() + idx] };
+        ASSERT_EQ(space.RunSimulation(input.data(), output.data()), 0);
+
+        for (size_t idx { 0 }; idx < input.size(); ++idx)
+            EXPECT_NEAR(results[k * input.size() + idx], output[idx], 1e-3f) << k << " " << idx;
+    }
+}
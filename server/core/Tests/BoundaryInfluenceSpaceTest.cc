@@ -0,0 +1,79 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include "TestPlate.hh"
+
+#include <gtest/gtest.h>
+#include <leth/BoundaryInfluenceSpace.hh>
+#include <leth/CholeskySpace.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr uint16_t width { 24 }, height { 18 };
+
+/// Changes boundary temperatures one at a time and compares every result with a direct solve.
+/// Returns the number of updates applied incrementally and the number solved again.
+void CompareWithDirectSolve(uint32_t flags, int& numIncremental, int& numSolved)
+{
+    constexpr float tolerance { 0.001f };
+
+    SpaceConfig config {};
+    config.flags     = flags;
+    config.tolerance = tolerance;
+
+    TestSpace<BoundaryInfluenceSpace> space { width, height, config };
+    TestSpace<CholeskySpace>          direct { width, height };
+
+    auto input { MakePlate(width, height, true, [](uint16_t, uint16_t) { return 20.0f; }) };
+
+    std::vector<float>                    result(input.size()), expected(input.size());
+    std::mt19937                          eng { 1 };
+    std::uniform_real_distribution<float> tempDist { 0.0f, 100.0f };
+
+    numIncremental = numSolved = 0;
+    for (int k { 0 }; k < 40; ++k)
+    {
+        input[5].temp = tempDist(eng);
+        if (k % 7 == 3)
+            input[4 * width].temp = tempDist(eng);
+
+        ASSERT_EQ(space.RunSimulation(input.data(), result.data()), 0u);
+        ASSERT_EQ(direct.RunSimulation(input.data(), expected.data()), 0u);
+
+        float maxError { 0.0f };
+        for (size_t i { 0 }; i < result.size(); ++i)
+            maxError = std::max(maxError, std::abs(result[i] - expected[i]));
+        EXPECT_LE(maxError, tolerance) << k;
+
+        // A solve uses the same factorization as `CholeskySpace`, so it matches exactly
+        if (k != 0)
+            ++(result == expected ? numSolved : numIncremental);
+    }
+}
+
+}
+
+TEST(BoundaryInfluenceSpaceTest, MatchesDirectSolve)
+{
+    int numIncremental, numSolved;
+    CompareWithDirectSolve(0, numIncremental, numSolved);
+    EXPECT_GT(numIncremental, 0);
+}
+
+TEST(BoundaryInfluenceSpaceTest, SolvesAgainWhenCompressionErrorsAccumulate)
+{
+    int numIncremental, numSolved;
+    CompareWithDirectSolve(static_cast<uint32_t>(SpaceFlag::CompressInfluence),
+                           numIncremental,
+                           numSolved);
+    EXPECT_GT(numIncremental, 0);
+    EXPECT_GT(numSolved, 0);
+}
+
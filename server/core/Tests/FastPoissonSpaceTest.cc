@@ -0,0 +1,64 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include "TestPlate.hh"
+
+#include <gtest/gtest.h>
+#include <leth/CholeskySpace.hh>
+#include <leth/FastPoissonSpace.hh>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// Makes a plate whose rim is a boundary of random temperatures. With `irregular`, a corner of
+/// the plate is cut out.
+std::vector<Point> MakeInput(uint16_t width, uint16_t height, bool irregular, uint32_t seed)
+{
+    std::mt19937                          engine { seed };
+    std::uniform_real_distribution<float> distribution { 0.0f, 100.0f };
+    return MakePlate(width, height, irregular, [&](uint16_t, uint16_t) {
+        return distribution(engine);
+    });
+}
+
+/// Returns the largest difference of the results of the fast Poisson and the Cholesky spaces.
+float GetMaxDifference(uint16_t width, uint16_t height, bool irregular)
+{
+    TestSpace<FastPoissonSpace> fastPoisson { width, height };
+    TestSpace<CholeskySpace>    cholesky { width, height };
+
+    float maxDifference { 0.0f };
+    for (uint32_t seed { 0 }; seed < 2; ++seed)
+    {
+        std::vector<Point> const input { MakeInput(width, height, irregular, seed) };
+        std::vector<float>       fastPoissonOutput(width * height), choleskyOutput(width * height);
+        EXPECT_EQ(fastPoisson.RunSimulation(input.data(), fastPoissonOutput.data()), 0);
+        EXPECT_EQ(cholesky.RunSimulation(input.data(), choleskyOutput.data()), 0);
+
+        for (size_t idx { 0 }; idx < input.size(); ++idx)
+        {
+            maxDifference = std::max(maxDifference,
+                                     std::abs(fastPoissonOutput[idx] - choleskyOutput[idx]));
+        }
+    }
+    return maxDifference;
+}
+
+}
+
+TEST(FastPoissonSpaceTest, SolvesRectangles)
+{
+    EXPECT_LT(GetMaxDifference(3, 3, false), 1e-4f);
+    EXPECT_LT(GetMaxDifference(16, 16, false), 1e-3f);
+    EXPECT_LT(GetMaxDifference(64, 40, false), 1e-3f);
+    EXPECT_LT(GetMaxDifference(43, 7, false), 1e-3f);
+}
+
+TEST(FastPoissonSpaceTest, FallsBackOnOtherDomains)
+{
+    EXPECT_LT(GetMaxDifference(32, 24, true), 1e-3f);
+}
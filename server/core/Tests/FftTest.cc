@@ -0,0 +1,91 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/Fft.hh>
+#include <leth/SineTransform.hh>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr double pi { 3.14159265358979323846 };
+
+}
+
+TEST(FftTest, MatchesDefinition)
+{
+    std::mt19937                           engine { 0 };
+    std::uniform_real_distribution<double> distribution { -1.0, 1.0 };
+
+    // Powers of two, mixed radices and lengths with large prime factors
+    for (size_t length : { 1, 2, 3, 4, 5, 8, 12, 16, 30, 34, 41, 64, 74, 98, 130, 1000 })
+    {
+        std::vector<Fft::Complex> data(length);
+        for (auto& value : data)
+        {
+            double const real { distribution(engine) };
+            value = Fft::Complex { real, distribution(engine) };
+        }
+
+        std::vector<Fft::Complex> expected(length);
+        for (size_t k { 0 }; k < length; ++k)
+        {
+            for (size_t j { 0 }; j < length; ++j)
+            {
+                double const angle { -2.0 * pi * static_cast<double>(j * k % length) / length };
+                expected[k] += data[j] * std::polar(1.0, angle);
+            }
+        }
+
+        Fft fft { length };
+        fft.Transform(data.data());
+        for (size_t k { 0 }; k < length; ++k)
+        {
+            EXPECT_NEAR(data[k].real(), expected[k].real(), 1e-9 * length) << length;
+            EXPECT_NEAR(data[k].imag(), expected[k].imag(), 1e-9 * length) << length;
+        }
+    }
+}
+
+TEST(FftTest, SineTransformMatchesDefinition)
+{
+    std::mt19937                           engine { 1 };
+    std::uniform_real_distribution<double> distribution { -1.0, 1.0 };
+
+    for (size_t length : { 1, 2, 7, 15, 16, 39, 62 })
+    {
+        std::vector<double> first(length), second(length);
+        for (auto& value : first) value = distribution(engine);
+        for (auto& value : second) value = distribution(engine);
+
+        auto const transform { [&](std::vector<double> const& values) {
+            std::vector<double> result(length, 0.0);
+            for (size_t k { 1 }; k <= length; ++k)
+            {
+                for (size_t j { 1 }; j <= length; ++j)
+                    result[k - 1] += values[j - 1] * std::sin(pi * j * k / (length + 1));
+            }
+            return result;
+        } };
+        std::vector<double> const expectedFirst { transform(first) };
+        std::vector<double> const expectedSecond { transform(second) };
+
+        SineTransform sineTransform { length };
+        sineTransform.Transform(first.data(), second.data());
+        for (size_t k { 0 }; k < length; ++k)
+        {
+            EXPECT_NEAR(first[k], expectedFirst[k], 1e-9 * length) << length;
+            EXPECT_NEAR(second[k], expectedSecond[k], 1e-9 * length) << length;
+        }
+
+        // A single sequence, transformed back
+        sineTransform.Transform(first.data(), nullptr);
+        std::vector<double> const restored { transform(expectedFirst) };
+        for (size_t k { 0 }; k < length; ++k) EXPECT_NEAR(first[k], restored[k], 1e-9 * length);
+    }
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/Journal.hh>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(JournalTest, RecordsCanBeReadBack)
+{
+    constexpr uint16_t width { 4 }, height { 3 };
+
+    std::vector<float> result(width * height, 0.0f);
+    {
+        Journal journal { width, height, 1 };
+        ASSERT_TRUE(journal.Start("journal-test", 0, 1));
+
+        journal.RecordSetPoint(1, 2, 12.5f, PointType::Boundary);
+        journal.RecordSetPoint(3, 0, -4.0f, PointType::OutOfRange);
+        journal.RecordSetPoint(1, 2, 12.75f, PointType::Boundary);
+
+        for (size_t i { 0 }; i < result.size(); ++i) result[i] = static_cast<float>(i) * 0.5f;
+        journal.RecordCheckpoint(0, 0, result.data());
+        journal.Stop();
+    }
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.Open("journal-test.0"));
+    ASSERT_EQ(reader.width(), width);
+    ASSERT_EQ(reader.height(), height);
+    ASSERT_EQ(reader.numSpaces(), 1);
+
+    JournalRecord record;
+    ASSERT_TRUE(reader.Next(record));
+    ASSERT_EQ(record.type, JournalRecordType::SetPoint);
+    ASSERT_EQ(record.x, 1);
+    ASSERT_EQ(record.y, 2);
+    ASSERT_EQ(record.temp, 12.5f);
+    ASSERT_EQ(record.pointType, PointType::Boundary);
+
+    ASSERT_TRUE(reader.Next(record));
+    ASSERT_EQ(record.x, 3);
+    ASSERT_EQ(record.y, 0);
+    ASSERT_EQ(record.temp, -4.0f);
+    ASSERT_EQ(record.pointType, PointType::OutOfRange);
+
+    int64_t const lastTime { record.time };
+    ASSERT_TRUE(reader.Next(record));
+    ASSERT_EQ(record.temp, 12.75f);
+    ASSERT_GE(record.time, lastTime);
+
+    ASSERT_TRUE(reader.Next(record));
+    ASSERT_EQ(record.type, JournalRecordType::Checkpoint);
+    ASSERT_EQ(record.spaceIdx, 0);
+    ASSERT_EQ(record.result, result);
+
+    ASSERT_FALSE(reader.Next(record));
+    std::remove("journal-test.0");
+}
+
+namespace
+{
+
+/// Reads every SetPoint temperature of the given journal file, in order.
+bool ReadTemperatures(char const* path, std::vector<float>& temps)
+{
+    JournalReader reader;
+    if (!reader.Open(path))
+        return false;
+
+    JournalRecord record;
+    while (reader.Next(record))
+    {
+        if (record.type == JournalRecordType::SetPoint)
+            temps.push_back(record.temp);
+    }
+    return true;
+}
+
+template <typename Condition>
+bool WaitFor(Condition condition)
+{
+    auto const deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 5 } };
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        if (condition())
+            return true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+}
+
+TEST(JournalTest, RotatesFiles)
+{
+    constexpr int numPoints { 8 };
+
+    {
+        // Every block exceeds the limit, so each block gets its own file
+        Journal journal { 4, 3, 1 };
+        ASSERT_TRUE(journal.Start("journal-rotation-test", 1, 0));
+        for (int i { 0 }; i < numPoints; ++i)
+        {
+            journal.RecordSetPoint(1, 1, static_cast<float>(i), PointType::Boundary);
+            std::this_thread::sleep_for(std::chrono::milliseconds(15));
+        }
+        journal.Stop();
+        EXPECT_EQ(journal.numDropped(), 0);
+    }
+
+    std::vector<float> temps;
+    int                numFiles { 0 };
+    while (true)
+    {
+        std::string const path { "journal-rotation-test." + std::to_string(numFiles) };
+        if (!ReadTemperatures(path.c_str(), temps))
+            break;
+
+        std::remove(path.c_str());
+        ++numFiles;
+    }
+
+    EXPECT_GT(numFiles, 1);
+    ASSERT_EQ(temps.size(), static_cast<size_t>(numPoints));
+    for (int i { 0 }; i < numPoints; ++i) EXPECT_EQ(temps[i], static_cast<float>(i));
+}
+
+TEST(JournalTest, CountsRecordsThatCannotBeWritten)
+{
+    namespace fs = std::filesystem;
+
+    fs::path const directory { "journal-dropped-test" };
+    fs::remove_all(directory);
+    ASSERT_TRUE(fs::create_directory(directory));
+    std::string const path { (directory / "journal").string() };
+
+    Journal journal { 4, 3, 1 };
+    ASSERT_TRUE(journal.Start(path.c_str(), 1, 0));
+
+    // Rotation fails once the directory is gone, so the following records cannot be written
+    journal.RecordSetPoint(0, 0, 1.0f, PointType::Boundary);
+    ASSERT_TRUE(WaitFor([&] { return fs::exists(path + ".1"); }));
+    fs::remove_all(directory);
+
+    ASSERT_TRUE(WaitFor([&] {
+        journal.RecordSetPoint(0, 0, 2.0f, PointType::Boundary);
+        return journal.numDropped() != 0;
+    }));
+    EXPECT_TRUE(journal.IsActive());
+
+    // The next file reports the dropped records before the records written afterwards
+    ASSERT_TRUE(fs::create_directory(directory));
+    journal.RecordSetPoint(0, 0, 3.0f, PointType::Boundary);
+    journal.Stop();
+
+    std::vector<JournalRecord> records;
+    for (auto const& entry : fs::directory_iterator { directory })
+    {
+        JournalReader reader;
+        ASSERT_TRUE(reader.Open(entry.path().string().c_str()));
+
+        JournalRecord record;
+        while (reader.Next(record)) records.push_back(record);
+    }
+    fs::remove_all(directory);
+
+    // Updates recorded after the last failed write may precede the last update
+    ASSERT_GE(records.size(), 2);
+    EXPECT_EQ(records.front().type, JournalRecordType::Dropped);
+    EXPECT_EQ(records.front().numDropped, journal.numDropped());
+    for (size_t i { 1 }; i < records.size(); ++i)
+    {
+        EXPECT_EQ(records[i].type, JournalRecordType::SetPoint);
+        EXPECT_EQ(records[i].temp, i + 1 == records.size() ? 3.0f : 2.0f);
+    }
+}
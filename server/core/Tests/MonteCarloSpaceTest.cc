@@ -0,0 +1,179 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/Lib.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr uint16_t width { 12 }, height { 10 };
+
+/// Sets the rim of the plate to a boundary with the given temperatures, removes the points in
+/// `cutout` and waits until every space has solved the result.
+template <typename Temperature, typename Cutout>
+void SetPlate(ServerHandle server, Temperature temperature, Cutout cutout)
+{
+    uint64_t numSets { 0 };
+    for (uint16_t y { 0 }; y < height; ++y)
+    {
+        for (uint16_t x { 0 }; x < width; ++x)
+        {
+            if (cutout(x, y))
+                leth_set(server, x, y, 0.0f, PointType::OutOfRange);
+            else if (y == 0 || x == 0 || y == height - 1 || x == width - 1)
+                leth_set(server, x, y, temperature(x, y), PointType::Boundary);
+            else
+                continue;
+            ++numSets;
+        }
+    }
+
+    auto const deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 30 } };
+    float      temp[width * height];
+    for (SpaceIndex spaceIdx { 0 }; spaceIdx < leth_get_num_spaces(server); ++spaceIdx)
+    {
+        uint64_t generation { 0 };
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            leth_get_res_with_generation(server, spaceIdx, temp, &generation);
+            if (generation == numSets)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+        }
+        ASSERT_EQ(generation, numSets);
+    }
+}
+
+}
+
+TEST(MonteCarloSpaceTest, ReachesTheTargetStandardError)
+{
+    constexpr float    targetError { 0.5f };
+    constexpr uint32_t numWalks { 100000 };
+
+    SpaceConfig spaces[1] {};
+    spaces[0].name      = "MonteCarloSpace";
+    spaces[0].tolerance = targetError;
+    spaces[0].numWalks  = numWalks;
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = spaces;
+    config.numSpaces = 1;
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    // The temperature of every inner point is then `10 * x`, both exactly and for the discrete
+    // equation
+    SetPlate(
+        server,
+        [](uint16_t x, uint16_t) { return 10.0f * x; },
+        [](uint16_t, uint16_t) { return false; });
+
+    float      temp[width * height], error[width * height];
+    SpaceStats stats;
+    ASSERT_EQ(leth_get_res(server, 0, temp), 0u);
+    ASSERT_EQ(leth_get_res_stats(server, 0, &stats), 0u);
+    ASSERT_TRUE(leth_get_res_error(server, 0, error));
+
+    // The target is met long before the walk budget is spent
+    uint64_t const numInner { (width - 2u) * (height - 2u) };
+    EXPECT_LE(stats.maxStandardError, targetError);
+    EXPECT_GT(stats.numIterations, 1u);
+    EXPECT_LT(stats.numSamples, numInner * numWalks / 10);
+
+    // The errors are nonzero exactly where walks were taken and cover the exact solution at about
+    // the rate of a normal distribution
+    float    maxError { 0.0f };
+    uint32_t numCovered { 0 };
+    for (uint16_t y { 0 }; y < height; ++y)
+    {
+        for (uint16_t x { 0 }; x < width; ++x)
+        {
+            size_t const idx { static_cast<size_t>(y) * width + x };
+            if (y == 0 || x == 0 || y == height - 1 || x == width - 1)
+            {
+                EXPECT_EQ(temp[idx], 10.0f * x);
+                EXPECT_EQ(error[idx], 0.0f);
+                continue;
+            }
+
+            EXPECT_GT(error[idx], 0.0f) << x << ", " << y;
+            EXPECT_LE(error[idx], targetError) << x << ", " << y;
+            EXPECT_LE(std::abs(temp[idx] - 10.0f * x), 5.0f * error[idx]) << x << ", " << y;
+            maxError = std::max(maxError, error[idx]);
+            if (std::abs(temp[idx] - 10.0f * x) <= 2.0f * error[idx])
+                ++numCovered;
+        }
+    }
+    EXPECT_EQ(maxError, stats.maxStandardError);
+    EXPECT_GE(numCovered, numInner * 85 / 100);
+
+    leth_delete(server);
+}
+
+TEST(MonteCarloSpaceTest, WalksAreUnbiased)
+{
+    constexpr float targetError { 0.5f };
+
+    SpaceConfig spaces[2] {};
+    spaces[0].name      = "MonteCarloSpace";
+    spaces[0].tolerance = targetError;
+    spaces[0].numWalks  = 1000000;
+    spaces[1].name      = "CholeskySpace";
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = spaces;
+    config.numSpaces = 2;
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    // The directions of every lane for two steps are cut from a single draw; a correlation between
+    // them would make the walks drift. On an L-shaped plate whose boundary varies in both
+    // directions and jumps at the top, the walks must turn corners and any drift shows. Every
+    // point is close to boundaries of varied temperatures: if nearly all walks from a point ended
+    // at the same temperature, too few would differ to estimate its standard error.
+    SetPlate(
+        server,
+        [](uint16_t x, uint16_t y) {
+            return 50.0f + 5.0f * x - 4.0f * y + (y == 0 ? 40.0f : 0.0f);
+        },
+        [](uint16_t x, uint16_t y) { return x > width / 2 && y > height / 2; });
+
+    float temp[width * height], expected[width * height], error[width * height];
+    ASSERT_EQ(leth_get_res(server, 0, temp), 0u);
+    ASSERT_EQ(leth_get_res(server, 1, expected), 0u);
+    ASSERT_TRUE(leth_get_res_error(server, 0, error));
+
+    // Each point is within a few standard errors, and so is the mean of the deviations, which
+    // would reveal a bias too small to show at any single point
+    double   sumDeviations { 0.0 };
+    uint32_t numSampled { 0 };
+    for (size_t idx { 0 }; idx < static_cast<size_t>(width) * height; ++idx)
+    {
+        if (error[idx] == 0.0f)
+            continue;
+
+        float const deviation { (temp[idx] - expected[idx]) / error[idx] };
+        EXPECT_LE(std::abs(deviation), 5.0f) << idx;
+        sumDeviations += deviation;
+        ++numSampled;
+    }
+    ASSERT_GT(numSampled, 0u);
+    EXPECT_LE(std::abs(sumDeviations / numSampled), 4.0 / std::sqrt(numSampled));
+
+    leth_delete(server);
+}
@@ -0,0 +1,133 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/ResultEncoding.hh>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+std::vector<float> MakeField(size_t width, size_t height, float phase)
+{
+    std::vector<float> field(width * height);
+    for (size_t i { 0 }; i < height; ++i)
+    {
+        for (size_t j { 0 }; j < width; ++j)
+            field[i * width + j] = 20.0f + 30.0f * std::sin(0.1f * i + phase) * std::cos(0.2f * j);
+    }
+    return field;
+}
+
+uint32_t Combine(ResultEncodingFlag lhs, ResultEncodingFlag rhs)
+{
+    return static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs);
+}
+
+}
+
+TEST(ResultEncodingTest, RoundTripsWithinReportedError)
+{
+    auto const           field { MakeField(64, 48, 0.0f) };
+    std::vector<uint8_t> encoded(GetEncodedResultBound(field.size()));
+
+    float        maxError;
+    size_t const size { EncodeResult(field.data(),
+                                     field.size(),
+                                     7,
+                                     static_cast<uint32_t>(ResultEncodingFlag::Entropy),
+                                     nullptr,
+                                     0,
+                                     encoded.data(),
+                                     &maxError) };
+    ASSERT_GT(size, 0u);
+    ASSERT_LT(size, field.size() * 2);
+    ASSERT_LE(maxError, 60.0f / 65535);
+
+    std::vector<float> decoded(field.size());
+    uint64_t           generation;
+    ASSERT_TRUE(DecodeResult(encoded.data(),
+                             size,
+                             nullptr,
+                             0,
+                             decoded.data(),
+                             decoded.size(),
+                             &generation));
+    ASSERT_EQ(generation, 7u);
+    for (size_t i { 0 }; i < field.size(); ++i) ASSERT_NEAR(decoded[i], field[i], maxError);
+}
+
+TEST(ResultEncodingTest, DeltaFramesNeedTheirReference)
+{
+    auto const           reference { MakeField(32, 32, 0.0f) };
+    std::vector<uint8_t> referenceEncoded(GetEncodedResultBound(reference.size()));
+    float                maxError;
+    size_t const         referenceSize { EncodeResult(reference.data(),
+                                                      reference.size(),
+                                                      1,
+                                                      0,
+                                                      nullptr,
+                                                      0,
+                                                      referenceEncoded.data(),
+                                                      &maxError) };
+
+    auto field { reference };
+    field[100] += 0.5f;
+
+    std::vector<uint8_t> encoded(GetEncodedResultBound(field.size()));
+    size_t const         size { EncodeResult(field.data(),
+                                             field.size(),
+                                             2,
+                                             Combine(ResultEncodingFlag::Delta,
+                                                     ResultEncodingFlag::Entropy),
+                                             referenceEncoded.data(),
+                                             referenceSize,
+                                             encoded.data(),
+                                             &maxError) };
+    ASSERT_GT(size, 0u);
+    ASSERT_LT(size, referenceSize / 8);
+
+    std::vector<float> decoded(field.size());
+    ASSERT_FALSE(
+        DecodeResult(encoded.data(), size, nullptr, 0, decoded.data(), decoded.size(), nullptr));
+    ASSERT_TRUE(DecodeResult(encoded.data(),
+                             size,
+                             referenceEncoded.data(),
+                             referenceSize,
+                             decoded.data(),
+                             decoded.size(),
+                             nullptr));
+    for (size_t i { 0 }; i < field.size(); ++i) ASSERT_NEAR(decoded[i], field[i], maxError);
+}
+
+TEST(ResultEncodingTest, RejectsCorruptedLengths)
+{
+    auto const           field { MakeField(16, 8, 0.0f) };
+    std::vector<uint8_t> encoded(GetEncodedResultBound(field.size()));
+
+    size_t const size { EncodeResult(field.data(),
+                                     field.size(),
+                                     0,
+                                     static_cast<uint32_t>(ResultEncodingFlag::Entropy),
+                                     nullptr,
+                                     0,
+                                     encoded.data(),
+                                     nullptr) };
+    ASSERT_GT(size, 0u);
+
+    std::vector<float> decoded(field.size());
+    ASSERT_FALSE(
+        DecodeResult(encoded.data(), 40, nullptr, 0, decoded.data(), decoded.size(), nullptr));
+
+    // The length is stored at bytes 8 to 11
+    for (size_t i { 8 }; i < 12; ++i) encoded[i] = 0xff;
+    ASSERT_FALSE(
+        DecodeResult(encoded.data(), size, nullptr, 0, decoded.data(), decoded.size(), nullptr));
+
+    // A payload this short cannot hold 2^32 - 1 values, even when the caller expects as many
+    ASSERT_FALSE(
+        DecodeResult(encoded.data(), size, nullptr, 0, decoded.data(), 0xffffffff, nullptr));
+}
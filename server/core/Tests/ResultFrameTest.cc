@@ -0,0 +1,89 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/Lib.hh>
+#include <leth/ResultFrame.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST(ResultFrameTest, RecyclesFramesAfterTheLastRelease)
+{
+    ResultFramePool pool { 4 };
+
+    ResultFrame* const first { pool.Acquire() };
+    first->data()[0] = 1.0f;
+    first->SetResult(0, 3, SpaceStats {});
+    first->Retain();
+
+    // A frame with a reference left is not handed out again
+    first->Release();
+    ResultFrame* const second { pool.Acquire() };
+    EXPECT_NE(second, first);
+    EXPECT_EQ(first->temp()[0], 1.0f);
+    EXPECT_EQ(first->generation(), 3u);
+
+    // The released frame comes back with its contents
+    first->Release();
+    ResultFrame* const third { pool.Acquire() };
+    EXPECT_EQ(third, first);
+    EXPECT_EQ(third->temp()[0], 1.0f);
+
+    second->Release();
+    third->Release();
+}
+
+TEST(ResultFrameTest, HeldResultsAreNotRecycled)
+{
+    constexpr uint16_t width { 8 }, height { 6 };
+
+    SpaceConfig space {};
+    space.name = "CholeskySpace";
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = &space;
+    config.numSpaces = 1;
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    float const* held;
+    uint64_t     heldGeneration;
+    ResultHandle heldResult { leth_acquire_res(server, 0, &held, nullptr, &heldGeneration) };
+    ASSERT_NE(heldResult, nullptr);
+    std::vector<float> const copy(held, held + width * height);
+
+    // The results of every update must come from other frames
+    for (uint16_t x { 0 }; x < width; ++x)
+    {
+        leth_set(server, x, 0, 10.0f * (x + 1), PointType::Boundary);
+
+        uint64_t   generation { 0 };
+        auto const deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 10 } };
+        while (generation != x + 1u && std::chrono::steady_clock::now() < deadline)
+        {
+            float const* temp;
+            ResultHandle result { leth_acquire_res(server, 0, &temp, nullptr, &generation) };
+            if (generation != heldGeneration)
+            {
+                EXPECT_NE(result, heldResult);
+            }
+            leth_release_res(server, result);
+        }
+        ASSERT_EQ(generation, x + 1u);
+    }
+
+    EXPECT_EQ(std::vector<float>(held, held + width * height), copy);
+    uint64_t generation;
+    float    temp[width * height];
+    leth_get_res_with_generation(server, 0, temp, &generation);
+    EXPECT_NE(generation, heldGeneration);
+
+    leth_release_res(server, heldResult);
+    leth_delete(server);
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/Lib.hh>
+#include <leth/ThreadPolicy.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#    include <sched.h>
+#    include <sys/resource.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace
+{
+
+constexpr uint16_t width { 12 }, height { 10 };
+
+/// Waits until the space publishes a result of the given input generation.
+bool WaitForResult(ServerHandle server, SpaceIndex spaceIdx, uint64_t expectedGeneration)
+{
+    auto const deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 10 } };
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        float const* temp;
+        uint64_t     generation;
+        ResultHandle result { leth_acquire_res(server, spaceIdx, &temp, nullptr, &generation) };
+        leth_release_res(server, result);
+
+        if (generation == expectedGeneration)
+            return true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+/// Returns whether the space published a result within the given time. The first result is held
+/// meanwhile, so a new result cannot reuse its frame.
+bool PublishesWithin(ServerHandle server, SpaceIndex spaceIdx, std::chrono::milliseconds time)
+{
+    float const* temp;
+    ResultHandle first { leth_acquire_res(server, spaceIdx, &temp, nullptr, nullptr) };
+
+    bool       published { false };
+    auto const deadline { std::chrono::steady_clock::now() + time };
+    while (!published && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        ResultHandle latest { leth_acquire_res(server, spaceIdx, &temp, nullptr, nullptr) };
+        published = latest != first;
+        leth_release_res(server, latest);
+    }
+
+    leth_release_res(server, first);
+    return published;
+}
+
+}
+
+#ifdef __linux__
+
+TEST(SchedulingTest, AppliesThreadPolicy)
+{
+    std::thread { [] {
+        // Pins the thread to a core it may already run on, which need not be core 0
+        cpu_set_t cpus;
+        ASSERT_EQ(sched_getaffinity(0, sizeof(cpus), &cpus), 0);
+        int cpu { 0 };
+        while (cpu < 64 && !CPU_ISSET(cpu, &cpus)) ++cpu;
+        if (cpu == 64)
+            GTEST_SKIP() << "No core below 64 is available";
+
+        EXPECT_TRUE(ApplyThreadPolicy(ThreadPolicy { uint64_t { 1 } << cpu, 5, true }));
+
+        ASSERT_EQ(sched_getaffinity(0, sizeof(cpus), &cpus), 0);
+        EXPECT_EQ(CPU_COUNT(&cpus), 1);
+        EXPECT_TRUE(CPU_ISSET(cpu, &cpus));
+
+        EXPECT_EQ(sched_getscheduler(0), SCHED_BATCH);
+        EXPECT_EQ(getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid))), 5);
+    } }.join();
+}
+
+#endif
+
+TEST(SchedulingTest, IdlesWhenConverged)
+{
+    SpaceConfig spaces[1] {};
+    spaces[0].name = "CholeskySpace";
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = spaces;
+    config.numSpaces = 1;
+    config.flags     = static_cast<uint32_t>(ServerFlag::IdleWhenConverged);
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    for (uint16_t x { 0 }; x < width; ++x) leth_set(server, x, 0, 100.0f, PointType::Boundary);
+    ASSERT_TRUE(WaitForResult(server, 0, width));
+    EXPECT_FALSE(PublishesWithin(server, 0, std::chrono::milliseconds(100)));
+
+    // An update wakes the space up
+    leth_set(server, 0, height - 1, 50.0f, PointType::Boundary);
+    EXPECT_TRUE(WaitForResult(server, 0, width + 1));
+
+    leth_delete(server);
+}
+
+TEST(SchedulingTest, KeepsRefiningUntilConverged)
+{
+    // Gauss-Seidel takes seconds of single sweeps to converge on a plate this large
+    constexpr uint16_t largeWidth { 256 }, largeHeight { 256 };
+
+    SpaceConfig spaces[1] {};
+    spaces[0].name          = "SuccessiveOverRelaxationSpace";
+    spaces[0].maxIterations = 1;
+    spaces[0].omega         = 1.0f;
+
+    ServerConfig config {};
+    config.width     = largeWidth;
+    config.height    = largeHeight;
+    config.spaces    = spaces;
+    config.numSpaces = 1;
+    config.flags     = static_cast<uint32_t>(ServerFlag::IdleWhenConverged);
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    for (uint16_t x { 0 }; x < largeWidth; ++x)
+        leth_set(server, x, 0, 100.0f, PointType::Boundary);
+    ASSERT_TRUE(WaitForResult(server, 0, largeWidth));
+    EXPECT_TRUE(PublishesWithin(server, 0, std::chrono::seconds(2)));
+
+    leth_delete(server);
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/Lib.hh>
+#include <leth/SharedResults.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#    include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+namespace
+{
+
+/// Returns a shared memory object name no other test process uses
+std::string MakeName(char const* suffix)
+{
+    return "/leth-test-" + std::to_string(getpid()) + "-" + suffix;
+}
+
+}
+
+TEST(SharedResultsTest, DetectsOverwrittenFrames)
+{
+    std::string const     name { MakeName("ring") };
+    SharedResultPublisher publisher { 4, 3, 1 };
+    ASSERT_TRUE(publisher.Start(name.c_str(), 2));
+
+    SharedResultReader reader;
+    ASSERT_TRUE(reader.Open(name.c_str()));
+    EXPECT_EQ(reader.width(), 4);
+    EXPECT_EQ(reader.height(), 3);
+    EXPECT_EQ(reader.numSpaces(), 1);
+
+    SharedResultView view;
+    EXPECT_FALSE(reader.AcquireResult(0, view));
+    EXPECT_FALSE(reader.AcquireResult(1, view));
+
+    std::vector<float> temp(12, 1.0f);
+    publisher.PublishResult(0, 0, 7, SpaceStats {}, temp.data());
+    ASSERT_TRUE(reader.AcquireResult(0, view));
+    EXPECT_EQ(view.version, 1);
+    EXPECT_EQ(view.generation, 7);
+    EXPECT_EQ(view.temp[11], 1.0f);
+    EXPECT_TRUE(reader.IsValid(view));
+
+    // The second frame goes to the other slot; the third one overwrites the first
+    temp.assign(12, 2.0f);
+    publisher.PublishResult(0, 0, 8, SpaceStats {}, temp.data());
+    EXPECT_TRUE(reader.IsValid(view));
+    publisher.PublishResult(0, 0, 9, SpaceStats {}, temp.data());
+    EXPECT_FALSE(reader.IsValid(view));
+
+    ASSERT_TRUE(reader.AcquireResult(0, view));
+    EXPECT_EQ(view.version, 3);
+    EXPECT_EQ(view.generation, 9);
+    EXPECT_EQ(view.temp[0], 2.0f);
+
+    publisher.Stop();
+    SharedResultReader other;
+    EXPECT_FALSE(other.Open(name.c_str()));
+}
+
+TEST(SharedResultsTest, ReplacesObjectsWithoutDisturbingTheirReaders)
+{
+    std::string const     name { MakeName("replaced") };
+    SharedResultPublisher first { 4, 3, 1 };
+    ASSERT_TRUE(first.Start(name.c_str(), 4));
+
+    SharedResultReader oldReader;
+    ASSERT_TRUE(oldReader.Open(name.c_str()));
+
+    // A second publisher of the same name creates a smaller object of its own
+    SharedResultPublisher second { 2, 2, 1 };
+    ASSERT_TRUE(second.Start(name.c_str(), 2));
+
+    std::vector<float> temp(12, 1.0f);
+    first.PublishResult(0, 0, 5, SpaceStats {}, temp.data());
+
+    SharedResultView view;
+    ASSERT_TRUE(oldReader.AcquireResult(0, view));
+    EXPECT_EQ(view.generation, 5);
+    EXPECT_EQ(view.temp[11], 1.0f);
+    EXPECT_TRUE(oldReader.IsValid(view));
+
+    SharedResultReader newReader;
+    ASSERT_TRUE(newReader.Open(name.c_str()));
+    EXPECT_EQ(newReader.width(), 2);
+    EXPECT_FALSE(newReader.AcquireResult(0, view));
+
+    // Stopping the first publisher leaves the name to the second one
+    first.Stop();
+    EXPECT_TRUE(SharedResultReader {}.Open(name.c_str()));
+    second.Stop();
+    EXPECT_FALSE(SharedResultReader {}.Open(name.c_str()));
+}
+
+TEST(SharedResultsTest, PublishesServerResults)
+{
+    constexpr uint16_t width { 8 }, height { 6 };
+
+    std::string const name { MakeName("server") };
+
+    SpaceConfig spaces[1] {};
+    spaces[0].name = "CholeskySpace";
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = spaces;
+    config.numSpaces = 1;
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+    ASSERT_TRUE(leth_start_shared_results(server, name.c_str(), 0));
+    EXPECT_FALSE(leth_start_shared_results(server, name.c_str(), 0));
+
+    SharedResultReader reader;
+    ASSERT_TRUE(reader.Open(name.c_str()));
+
+    for (uint16_t x { 0 }; x < width; ++x) leth_set(server, x, 0, 100.0f, PointType::Boundary);
+    uint64_t const generation { width };
+
+    SharedResultView input {}, result {};
+    auto const       deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 10 } };
+    while ((!reader.AcquireInput(input) || input.generation != generation
+            || !reader.AcquireResult(0, result) || result.generation != generation)
+           && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(input.generation, generation);
+    ASSERT_EQ(result.generation, generation);
+
+    std::vector<float> expected(width * height);
+    uint64_t           expectedGeneration;
+    leth_get_res_with_generation(server, 0, expected.data(), &expectedGeneration);
+    ASSERT_EQ(expectedGeneration, generation);
+
+    for (size_t idx { 0 }; idx < expected.size(); ++idx)
+    {
+        EXPECT_EQ(result.temp[idx], expected[idx]);
+        EXPECT_EQ(input.type[idx], idx < width ? PointType::Boundary : PointType::GroundTruth);
+    }
+    EXPECT_TRUE(reader.IsValid(input));
+
+    leth_delete(server);
+    EXPECT_FALSE(SharedResultReader {}.Open(name.c_str()));
+}
+
+#endif
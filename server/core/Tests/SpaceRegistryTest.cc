@@ -0,0 +1,121 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/CholeskySpace.hh>
+#include <leth/Lib.hh>
+#include <leth/Server.hh>
+#include <leth/SpaceRegistry.hh>
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+
+constexpr uint16_t width { 8 }, height { 6 };
+
+ServerHandle Create(SpaceConfig const* spaces, uint32_t numSpaces)
+{
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = spaces;
+    config.numSpaces = numSpaces;
+    return leth_create_ex(&config);
+}
+
+}
+
+TEST(SpaceRegistryTest, CreatesEverySpaceByName)
+{
+    char const* const names[] {
+        "MonteCarloSpace",
+        "SuccessiveOverRelaxationSpace",
+        "FiniteElementMethodSpace",
+        "CholeskySpace",
+        "BoundaryInfluenceSpace",
+        "FastPoissonSpace",
+    };
+
+    for (char const* name : names)
+    {
+        SpaceConfig space {};
+        space.name = name;
+
+        ServerHandle server { Create(&space, 1) };
+        ASSERT_NE(server, nullptr) << name;
+        EXPECT_EQ(leth_get_num_spaces(server), 1);
+        leth_delete(server);
+    }
+}
+
+TEST(SpaceRegistryTest, RejectsUnknownNames)
+{
+    SpaceConfig spaces[2] {};
+    spaces[0].name = "CholeskySpace";
+
+    // A single unknown or missing name fails the whole server
+    spaces[1].name = "NoSuchSpace";
+    EXPECT_EQ(Create(spaces, 2), nullptr);
+
+    spaces[1].name = "choleskyspace";
+    EXPECT_EQ(Create(spaces, 2), nullptr);
+
+    spaces[1].name = nullptr;
+    EXPECT_EQ(Create(spaces, 2), nullptr);
+
+    EXPECT_EQ(Create(nullptr, 1), nullptr);
+    EXPECT_EQ(leth_create_ex(nullptr), nullptr);
+}
+
+TEST(SpaceRegistryTest, CreatesDuplicateNamesAsSeparateSpaces)
+{
+    SpaceConfig spaces[2] {};
+    spaces[0].name  = "SuccessiveOverRelaxationSpace";
+    spaces[0].omega = 1.0f;
+    spaces[1].name  = "SuccessiveOverRelaxationSpace";
+    spaces[1].omega = 1.5f;
+
+    ServerHandle server { Create(spaces, 2) };
+    ASSERT_NE(server, nullptr);
+    ASSERT_EQ(leth_get_num_spaces(server), 2);
+    EXPECT_STREQ(leth_get_space_name(server, 0), leth_get_space_name(server, 1));
+
+    float const* temp;
+    ResultHandle first { leth_acquire_res(server, 0, &temp, nullptr, nullptr) };
+    ResultHandle second { leth_acquire_res(server, 1, &temp, nullptr, nullptr) };
+    EXPECT_NE(first, second);
+    leth_release_res(server, first);
+    leth_release_res(server, second);
+
+    leth_delete(server);
+}
+
+TEST(SpaceRegistryTest, LooksUpTheGivenRegistry)
+{
+    SpaceRegistry registry;
+    registry.Register<CholeskySpace>("Direct");
+
+    SpaceConfig space {};
+    space.name = "Direct";
+
+    ServerConfig config {};
+    config.width     = width;
+    config.height    = height;
+    config.spaces    = &space;
+    config.numSpaces = 1;
+
+    ServerHandle server { Server::Make(config, registry) };
+    ASSERT_NE(server, nullptr);
+    EXPECT_STREQ(leth_get_space_name(server, 0), "Cholesky");
+    leth_delete(server);
+
+    // The names of the default registry are unknown to it
+    space.name = "CholeskySpace";
+    EXPECT_EQ(Server::Make(config, registry), nullptr);
+
+    server = leth_create_ex(&config);
+    ASSERT_NE(server, nullptr);
+    leth_delete(server);
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/SparseCholesky.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// Builds the five-point Laplacian of a `size` x `size` grid. With `dirichlet`, the rim of the
+/// grid borders fixed temperatures; otherwise it is insulated and the matrix is singular.
+SparseMatrix MakeLaplacian(uint32_t size, bool dirichlet)
+{
+    SparseMatrix A;
+    for (uint32_t i { 0 }; i < size; ++i)
+    {
+        for (uint32_t j { 0 }; j < size; ++j)
+        {
+            uint32_t numNeighbors { 0 };
+
+            A.rowStarts.push_back(static_cast<uint32_t>(A.columns.size()));
+            auto const addNeighbor { [&](uint32_t ni, uint32_t nj) {
+                A.columns.push_back(ni * size + nj);
+                A.values.push_back(1.0f);
+                ++numNeighbors;
+            } };
+
+            if (i > 0)
+                addNeighbor(i - 1, j);
+            if (j > 0)
+                addNeighbor(i, j - 1);
+            if (j + 1 < size)
+                addNeighbor(i, j + 1);
+            if (i + 1 < size)
+                addNeighbor(i + 1, j);
+
+            A.diagonal.push_back(dirichlet ? -4.0f : -static_cast<float>(numNeighbors));
+        }
+    }
+    A.rowStarts.push_back(static_cast<uint32_t>(A.columns.size()));
+
+    return A;
+}
+
+}
+
+TEST(SparseCholeskyTest, SolvesInAnyOrder)
+{
+    SparseMatrix const A { MakeLaplacian(12, true) };
+
+    std::mt19937          eng { 1 };
+    std::vector<uint32_t> order(A.size());
+    for (size_t i { 0 }; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    std::shuffle(order.begin(), order.end(), eng);
+
+    SparseCholesky factorization;
+    ASSERT_TRUE(factorization.Factorize(A, order));
+
+    std::uniform_real_distribution<float> dist { -100.0f, 100.0f };
+    std::vector<float>                    b(A.size()), x(A.size());
+    std::vector<double>                   work(A.size());
+    for (auto& value : b) value = dist(eng);
+
+    factorization.Solve(b.data(), x.data(), work.data());
+
+    for (size_t i { 0 }; i < A.size(); ++i)
+    {
+        double Ax { static_cast<double>(A.diagonal[i]) * x[i] };
+        for (uint32_t p { A.rowStarts[i] }; p < A.rowStarts[i + 1]; ++p)
+            Ax += static_cast<double>(A.values[p]) * x[A.columns[p]];
+
+        EXPECT_NEAR(Ax, b[i], 1e-3);
+    }
+}
+
+TEST(SparseCholeskyTest, SolvesSeveralRightHandSides)
+{
+    SparseMatrix const A { MakeLaplacian(10, true) };
+    size_t const       n { A.size() }, numRhs { 5 };
+
+    std::vector<uint32_t> order(n);
+    for (size_t i { 0 }; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+
+    SparseCholesky factorization;
+    ASSERT_TRUE(factorization.Factorize(A, order));
+
+    std::mt19937                          eng { 2 };
+    std::uniform_real_distribution<float> dist { -100.0f, 100.0f };
+    std::vector<float>                    b(n * numRhs), x(n * numRhs), expected(n);
+    std::vector<double>                   work(n * numRhs);
+    for (auto& value : b) value = dist(eng);
+
+    factorization.Solve(b.data(), x.data(), numRhs, work.data());
+
+    for (size_t r { 0 }; r < numRhs; ++r)
+    {
+        factorization.Solve(b.data() + r * n, expected.data(), work.data());
+        for (size_t i { 0 }; i < n; ++i) EXPECT_NEAR(x[r * n + i], expected[i], 1e-4);
+    }
+}
+
+TEST(SparseCholeskyTest, RejectsSingularMatrix)
+{
+    SparseMatrix const A { MakeLaplacian(6, false) };
+
+    std::vector<uint32_t> order(A.size());
+    for (size_t i { 0 }; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+
+    SparseCholesky factorization;
+    EXPECT_FALSE(factorization.Factorize(A, order));
+    EXPECT_EQ(factorization.size(), 0);
+}
@@ -0,0 +1,225 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+#include <leth/Lib.hh>
+#include <leth/SuccessiveOverRelaxationSpace.hh>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/// Exposes `RunSimulation` and the statistics of a space to the tests.
+class TestSpace : public SuccessiveOverRelaxationSpace
+{
+  public:
+    using SuccessiveOverRelaxationSpace::SuccessiveOverRelaxationSpace;
+    using SuccessiveOverRelaxationSpace::RunSimulation;
+    using SuccessiveOverRelaxationSpace::stats;
+};
+
+constexpr uint16_t width { 34 }, height { 26 };
+
+/// Makes a plate whose rim is a boundary at `temp`, with the top edge at 100. With `notch`, the
+/// lower right quarter is out of range.
+std::vector<Point> MakePlate(bool notch, float temp)
+{
+    std::vector<Point> input(static_cast<size_t>(width) * height);
+    for (uint16_t i { 0 }; i < height; ++i)
+    {
+        for (uint16_t j { 0 }; j < width; ++j)
+        {
+            Point& point { input[static_cast<size_t>(i) * width + j] };
+            if (i == 0)
+                point = Point { PointType::Boundary, 100.0f };
+            else if (j == 0 || i == height - 1 || j == width - 1)
+                point = Point { PointType::Boundary, temp };
+            else if (notch && i > height / 2 && j > width / 2)
+                point = Point { PointType::OutOfRange, 0.0f };
+            else
+                point = Point { PointType::GroundTruth, 0.0f };
+        }
+    }
+    return input;
+}
+
+/// Solves the plate and returns the statistics of the simulation.
+SpaceStats Solve(TestSpace& space, bool notch, float temp)
+{
+    auto const         input { MakePlate(notch, temp) };
+    std::vector<float> output(input.size());
+    EXPECT_EQ(space.RunSimulation(input.data(), output.data()), 0u);
+    return space.stats();
+}
+
+SpaceConfig MakeConfig(float omega)
+{
+    SpaceConfig config {};
+    config.omega     = omega;
+    config.tolerance = 1e-4f;
+    return config;
+}
+
+/// Represents a result seen by `Observe`.
+struct Observation
+{
+    uint64_t generation;
+    uint32_t resolutionLevel;
+};
+
+/// Appends the latest result to `observations` if it was not the last one seen. The statistics
+/// are only taken if the same result is still the latest after reading them.
+void Observe(ServerHandle server, ResultHandle& last, std::vector<Observation>& observations)
+{
+    float const* temp;
+    uint64_t     generation;
+    SpaceStats   stats;
+    ResultHandle result { leth_acquire_res(server, 0, &temp, nullptr, &generation) };
+    leth_get_res_stats(server, 0, &stats);
+    ResultHandle confirmed { leth_acquire_res(server, 0, &temp, nullptr, nullptr) };
+
+    if (result != last && confirmed == result)
+    {
+        observations.push_back(Observation { generation, stats.resolutionLevel });
+        last = result;
+    }
+    leth_release_res(server, confirmed);
+    leth_release_res(server, result);
+}
+
+/// Observes the results until a full result of the given generation is seen or the time runs
+/// out. Returns the index of the first observation of that generation.
+size_t ObserveUntilSolved(ServerHandle              server,
+                          uint64_t                  generation,
+                          ResultHandle&             last,
+                          std::vector<Observation>& observations)
+{
+    auto const deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 10 } };
+    size_t     first { observations.size() };
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        Observe(server, last, observations);
+        while (first < observations.size() && observations[first].generation != generation)
+            ++first;
+
+        if (first < observations.size() && observations.back().generation == generation
+            && observations.back().resolutionLevel == 0)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return first;
+}
+
+}
+
+TEST(SuccessiveOverRelaxationSpaceTest, UsesTheOptimalFactorOfRectangles)
+{
+    // The Jacobi radius of the model problem on a rectangle of n x m unknowns
+    double const pi { 3.14159265358979 };
+    double const mu { 0.5 * (std::cos(pi / (width - 1)) + std::cos(pi / (height - 1))) };
+    double const optimum { 2.0 / (1.0 + std::sqrt(1.0 - mu * mu)) };
+
+    TestSpace        space { width, height, MakeConfig(0.0f) };
+    SpaceStats const stats { Solve(space, false, 0.0f) };
+    EXPECT_NEAR(stats.omega, optimum, 1e-4);
+
+    // No factor nearby converges in fewer sweeps
+    for (float omega : { 1.0f, 1.75f, 1.85f, 1.9f })
+    {
+        TestSpace fixed { width, height, MakeConfig(omega) };
+        EXPECT_LE(stats.numIterations, Solve(fixed, false, 0.0f).numIterations) << omega;
+    }
+}
+
+TEST(SuccessiveOverRelaxationSpaceTest, RefinesTheFactorCachedPerTopology)
+{
+    TestSpace space { width, height, MakeConfig(0.0f) };
+
+    // The first estimate of an L-shaped plate is low, and every solve raises it until it settles
+    SpaceStats const first { Solve(space, true, 0.0f) };
+    SpaceStats       last { first };
+    for (int k { 1 }; k < 8; ++k)
+    {
+        SpaceStats const stats { Solve(space, true, k % 2 == 0 ? 0.0f : 50.0f) };
+        EXPECT_GE(stats.omega, last.omega);
+        last = stats;
+    }
+    EXPECT_GT(last.omega, first.omega);
+    EXPECT_LT(last.numIterations, first.numIterations);
+
+    // Another topology does not disturb the cached factor
+    Solve(space, false, 0.0f);
+    EXPECT_EQ(Solve(space, true, 50.0f).omega, last.omega);
+
+    // The settled factor is close to the best fixed factor. The solves above start from the
+    // previous solution, so the factors are compared on solves from scratch.
+    TestSpace        settled { width, height, MakeConfig(last.omega) };
+    SpaceStats const cold { Solve(settled, true, 50.0f) };
+    for (float omega : { 1.0f, 1.7f, 1.9f })
+    {
+        TestSpace fixed { width, height, MakeConfig(omega) };
+        EXPECT_LT(cold.numIterations, Solve(fixed, true, 50.0f).numIterations) << omega;
+    }
+}
+
+
+TEST(SuccessiveOverRelaxationSpaceTest, PublishesPreviewsBeforeFullResults)
+{
+    // A full solve of a new topology takes many times as long as its coarse preview
+    constexpr uint16_t largeWidth { 128 }, largeHeight { 128 };
+
+    SpaceConfig spaces[1] {};
+    spaces[0].name         = "SuccessiveOverRelaxationSpace";
+    spaces[0].previewScale = 4;
+
+    ServerConfig config {};
+    config.width     = largeWidth;
+    config.height    = largeHeight;
+    config.spaces    = spaces;
+    config.numSpaces = 1;
+
+    ServerHandle server { leth_create_ex(&config) };
+    ASSERT_NE(server, nullptr);
+
+    ResultHandle             last { nullptr };
+    std::vector<Observation> observations;
+    for (uint16_t x { 0 }; x < largeWidth; ++x)
+        leth_set(server, x, 0, 100.0f, PointType::Boundary);
+    size_t const solved { ObserveUntilSolved(server, largeWidth, last, observations) };
+    ASSERT_LT(solved, observations.size());
+
+    // The blank result a space starts with may be followed by a preview of the same generation,
+    // so only the results of the updates below are checked. Every update adds a boundary point,
+    // so each starts a new topology.
+    observations.clear();
+    for (uint16_t x { 0 }; x < 3; ++x)
+    {
+        uint64_t const generation { largeWidth + x + 1u };
+        leth_set(server, 32 * (x + 1), largeHeight - 1, 50.0f, PointType::Boundary);
+
+        size_t const first { ObserveUntilSolved(server, generation, last, observations) };
+        ASSERT_LT(first, observations.size());
+        EXPECT_EQ(observations[first].resolutionLevel, 2u) << generation;
+        EXPECT_EQ(observations.back().resolutionLevel, 0u) << generation;
+    }
+
+    // A preview only ever follows the full results of older inputs
+    for (size_t i { 1 }; i < observations.size(); ++i)
+    {
+        Observation const& previous { observations[i - 1] };
+        Observation const& current { observations[i] };
+        EXPECT_GE(current.generation, previous.generation);
+        if (current.resolutionLevel != 0)
+        {
+            EXPECT_GT(current.generation, previous.generation) << i;
+        }
+    }
+
+    leth_delete(server);
+}
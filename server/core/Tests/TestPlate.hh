@@ -0,0 +1,45 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_TEST_PLATE_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_TEST_PLATE_HH
+
+#include <leth/Point.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Exposes `RunSimulation` of a space to the tests.
+template <typename SpaceT>
+class TestSpace : public SpaceT
+{
+  public:
+    using SpaceT::SpaceT;
+    using SpaceT::RunSimulation;
+};
+
+/// Makes a plate whose rim is a boundary at `temperature(i, j)`, which is called for the points of
+/// the rim in row-major order. With `lShaped`, the points below and right of the center are out of
+/// range.
+template <typename Temperature>
+std::vector<Point> MakePlate(uint16_t width, uint16_t height, bool lShaped, Temperature temperature)
+{
+    std::vector<Point> input(static_cast<size_t>(width) * height);
+    for (uint16_t i { 0 }; i < height; ++i)
+    {
+        for (uint16_t j { 0 }; j < width; ++j)
+        {
+            Point& point { input[static_cast<size_t>(i) * width + j] };
+            if (i == 0 || j == 0 || i == height - 1 || j == width - 1)
+                point = Point { PointType::Boundary, temperature(i, j) };
+            else if (lShaped && i > height / 2 && j > width / 2)
+                point = Point { PointType::OutOfRange, 0.0f };
+            else
+                point = Point { PointType::GroundTruth, 0.0f };
+        }
+    }
+    return input;
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Trace.hh"
+
+#include <gtest/gtest.h>
+#include <leth/Journal.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/// Returns the paths of every file of the given journal.
+std::vector<std::string> GetJournalFiles(char const* path)
+{
+    std::vector<std::string> paths;
+    while (true)
+    {
+        std::string file { std::string { path } + "." + std::to_string(paths.size()) };
+        if (!JournalReader {}.Open(file.c_str()))
+            return paths;
+
+        paths.push_back(std::move(file));
+    }
+}
+
+}
+
+TEST(TraceTest, ReplaysRotatedJournalsWithTheirTiming)
+{
+    constexpr int numPoints { 6 };
+
+    {
+        // Every block exceeds the limit, so each block gets its own file
+        Journal journal { 4, 3, 1 };
+        ASSERT_TRUE(journal.Start("trace-rotation-test", 1, 0));
+        for (int i { 0 }; i < numPoints; ++i)
+        {
+            journal.RecordSetPoint(1, 2, static_cast<float>(i), PointType::Boundary);
+            std::this_thread::sleep_for(std::chrono::milliseconds(15));
+        }
+        journal.Stop();
+    }
+
+    std::vector<std::string> const paths { GetJournalFiles("trace-rotation-test") };
+    EXPECT_GE(paths.size(), 3u);
+
+    // The times of every file count from the start of the journal
+    std::vector<int64_t> times;
+    for (auto& path : paths)
+    {
+        JournalReader reader;
+        ASSERT_TRUE(reader.Open(path.c_str()));
+
+        JournalRecord record;
+        while (reader.Next(record))
+        {
+            if (record.type == JournalRecordType::SetPoint)
+                times.push_back(record.time);
+        }
+    }
+    ASSERT_EQ(times.size(), static_cast<size_t>(numPoints));
+
+    uint16_t                width { 0 }, height { 0 };
+    std::vector<TraceEvent> events;
+    ASSERT_TRUE(LoadTrace(paths, width, height, events));
+    EXPECT_EQ(width, 4);
+    EXPECT_EQ(height, 3);
+
+    ASSERT_EQ(events.size(), static_cast<size_t>(numPoints));
+    for (int i { 0 }; i < numPoints; ++i)
+    {
+        EXPECT_EQ(events[i].time, times[i]) << i;
+        EXPECT_EQ(events[i].temp, static_cast<float>(i));
+        EXPECT_EQ(events[i].x, 1);
+        EXPECT_EQ(events[i].y, 2);
+    }
+
+    for (auto& path : paths) std::remove(path.c_str());
+}
+
+TEST(TraceTest, LinesUpSeparateJournals)
+{
+    using namespace std::chrono_literals;
+
+    Journal first { 4, 3, 1 }, second { 4, 3, 1 };
+    ASSERT_TRUE(first.Start("trace-first-test", 0, 0));
+    first.RecordSetPoint(0, 0, 0.0f, PointType::Boundary);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(second.Start("trace-second-test", 0, 0));
+    second.RecordSetPoint(1, 0, 1.0f, PointType::Boundary);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    first.RecordSetPoint(2, 0, 2.0f, PointType::Boundary);
+    first.Stop();
+    second.Stop();
+
+    // The second journal started later, so its record comes between those of the first one
+    uint16_t                width, height;
+    std::vector<TraceEvent> events;
+    ASSERT_TRUE(LoadTrace({ "trace-first-test.0", "trace-second-test.0" }, width, height, events));
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].temp, 0.0f);
+    EXPECT_EQ(events[1].temp, 1.0f);
+    EXPECT_EQ(events[2].temp, 2.0f);
+    EXPECT_GE(events[1].time - events[0].time, std::chrono::nanoseconds { 40ms }.count());
+    EXPECT_GE(events[2].time - events[1].time, std::chrono::nanoseconds { 10ms }.count());
+
+    std::remove("trace-first-test.0");
+    std::remove("trace-second-test.0");
+}
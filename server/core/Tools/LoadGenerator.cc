@@ -0,0 +1,349 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+// Replays a trace of `leth_set` calls against a server through the C API and reports, per space,
+// the latency from an update being sent by `leth_set` until a full-resolution result reflecting it
+// is readable through `leth_acquire_res`. Results are polled, so a latency includes up to one
+// polling interval of at most 1 ms.
+
+#include "Trace.hh"
+
+#include <leth/Lib.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Readers poll for results with an exponential backoff, so that they take little CPU time and few
+// result locks from the spaces while still seeing a new result soon after it is published
+constexpr std::chrono::microseconds minPollInterval { 20 }, maxPollInterval { 1000 };
+
+struct Options
+{
+    uint16_t                 width { 16 }, height { 16 };
+    std::vector<std::string> tracePaths;
+    std::vector<std::string> spaceNames;
+    uint32_t                 numThreads { 0 };
+    double                   rate { 1000.0 };
+    uint32_t                 numProducers { 1 };
+    double                   duration { 10.0 };
+    double                   drainTimeout { 10.0 };
+    uint32_t                 seed { 0 };
+};
+
+void PrintUsage()
+{
+    std::fprintf(
+        stderr,
+        "Usage: laplace-eq-therm-load-generator [options]\n"
+        "  --trace <path>       replays the point updates of a journal file (repeatable)\n"
+        "  --width <n>          width of the synthetic plate (default: 16)\n"
+        "  --height <n>         height of the synthetic plate (default: 16)\n"
+        "  --space <name>       runs only the given space (repeatable; default: all spaces)\n"
+        "  --threads <n>        number of threads of each space (default: 1)\n"
+        "  --rate <n>           updates per second over all producers; 0 replays a trace with\n"
+        "                       its recorded timing (default: 1000)\n"
+        "  --producers <n>      number of threads calling leth_set (default: 1)\n"
+        "  --duration <s>       length of the synthetic trace in seconds (default: 10)\n"
+        "  --drain-timeout <s>  time to wait for the results to catch up (default: 10)\n"
+        "  --seed <n>           seed of the synthetic trace (default: 0)\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i { 1 }; i < argc; ++i)
+    {
+        char const* name { argv[i] };
+        if (i + 1 >= argc)
+            return false;
+
+        char const* value { argv[++i] };
+        if (std::strcmp(name, "--trace") == 0)
+            options.tracePaths.push_back(value);
+        else if (std::strcmp(name, "--width") == 0)
+            options.width = static_cast<uint16_t>(std::atoi(value));
+        else if (std::strcmp(name, "--height") == 0)
+            options.height = static_cast<uint16_t>(std::atoi(value));
+        else if (std::strcmp(name, "--space") == 0)
+            options.spaceNames.push_back(value);
+        else if (std::strcmp(name, "--threads") == 0)
+            options.numThreads = static_cast<uint32_t>(std::atoi(value));
+        else if (std::strcmp(name, "--rate") == 0)
+            options.rate = std::atof(value);
+        else if (std::strcmp(name, "--producers") == 0)
+            options.numProducers = static_cast<uint32_t>(std::atoi(value));
+        else if (std::strcmp(name, "--duration") == 0)
+            options.duration = std::atof(value);
+        else if (std::strcmp(name, "--drain-timeout") == 0)
+            options.drainTimeout = std::atof(value);
+        else if (std::strcmp(name, "--seed") == 0)
+            options.seed = static_cast<uint32_t>(std::atoi(value));
+        else
+            return false;
+    }
+
+    if (options.tracePaths.empty() && options.rate <= 0.0)
+        return false;
+
+    return options.width >= 3 && options.height >= 3 && options.numProducers > 0;
+}
+
+/// Builds a plate whose rim is a boundary and streams random temperature changes of the rim.
+void MakeSyntheticTrace(Options const& options, std::vector<TraceEvent>& events)
+{
+    std::mt19937                          eng { options.seed };
+    std::uniform_real_distribution<float> tempDist { 0.0f, 100.0f };
+
+    std::vector<std::pair<uint16_t, uint16_t>> rim;
+    for (uint16_t y { 0 }; y < options.height; ++y)
+    {
+        for (uint16_t x { 0 }; x < options.width; ++x)
+        {
+            bool const onRim { x == 0 || y == 0 || x + 1 == options.width
+                               || y + 1 == options.height };
+            if (onRim)
+                rim.emplace_back(x, y);
+
+            events.push_back(TraceEvent {
+                0,
+                x,
+                y,
+                onRim ? tempDist(eng) : 0.0f,
+                onRim ? PointType::Boundary : PointType::GroundTruth,
+            });
+        }
+    }
+
+    std::uniform_int_distribution<size_t> rimDist { 0, rim.size() - 1 };
+    size_t const numUpdates { static_cast<size_t>(options.rate * options.duration) };
+    for (size_t i { 0 }; i < numUpdates; ++i)
+    {
+        auto& pos { rim[rimDist(eng)] };
+        events.push_back(TraceEvent {
+            static_cast<int64_t>(1e9 * i / options.rate),
+            pos.first,
+            pos.second,
+            tempDist(eng),
+            PointType::Boundary,
+        });
+    }
+}
+
+double GetPercentile(std::vector<double> const& sorted, double quantile)
+{
+    if (sorted.empty())
+        return 0.0;
+
+    size_t const idx { std::min(sorted.size() - 1, static_cast<size_t>(quantile * sorted.size())) };
+    return sorted[idx];
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<TraceEvent> events;
+    if (options.tracePaths.empty())
+        MakeSyntheticTrace(options, events);
+    else
+    {
+        if (!LoadTrace(options.tracePaths, options.width, options.height, events))
+            return 1;
+
+        // Replaces the recorded timing with the given rate
+        if (options.rate > 0.0)
+        {
+            for (size_t i { 0 }; i < events.size(); ++i)
+                events[i].time = static_cast<int64_t>(1e9 * i / options.rate);
+        }
+    }
+
+    ServerHandle server;
+    if (options.spaceNames.empty() && options.numThreads == 0)
+        server = leth_create(options.width, options.height);
+    else
+    {
+        if (options.spaceNames.empty())
+        {
+            options.spaceNames = {
+                "MonteCarloSpace",
+                "SuccessiveOverRelaxationSpace",
+                "FiniteElementMethodSpace",
+            };
+        }
+
+        std::vector<SpaceConfig> spaces(options.spaceNames.size(), SpaceConfig {});
+        for (size_t i { 0 }; i < spaces.size(); ++i)
+        {
+            spaces[i].name       = options.spaceNames[i].c_str();
+            spaces[i].numThreads = options.numThreads;
+        }
+
+        ServerConfig config {};
+        config.width     = options.width;
+        config.height    = options.height;
+        config.spaces    = spaces.data();
+        config.numSpaces = static_cast<uint32_t>(spaces.size());
+        server           = leth_create_ex(&config);
+    }
+
+    if (server == nullptr)
+    {
+        std::fprintf(stderr, "Cannot create a server\n");
+        return 1;
+    }
+
+    SpaceIndex const numSpaces { leth_get_num_spaces(server) };
+    uint64_t const   baseGeneration { leth_get_generation(server) };
+
+    std::atomic_bool                   stopped { false };
+    std::vector<Clock::time_point>     sendTimes(events.size());
+    std::vector<std::vector<double>>   latencies(numSpaces);
+    std::vector<std::atomic<uint64_t>> observedGenerations(numSpaces);
+
+    std::vector<std::thread> readers;
+    for (SpaceIndex spaceIdx { 0 }; spaceIdx < numSpaces; ++spaceIdx)
+    {
+        observedGenerations[spaceIdx] = baseGeneration;
+        readers.emplace_back([&, spaceIdx] {
+            auto pollInterval { minPollInterval };
+            while (!stopped)
+            {
+                // The statistics belong to the acquired result only if no result was published
+                // in between
+                float const*       temp;
+                uint64_t           generation;
+                SpaceStats         stats;
+                ResultHandle const result {
+                    leth_acquire_res(server, spaceIdx, &temp, nullptr, &generation),
+                };
+                leth_get_res_stats(server, spaceIdx, &stats);
+                ResultHandle const latest {
+                    leth_acquire_res(server, spaceIdx, &temp, nullptr, nullptr),
+                };
+                leth_release_res(server, result);
+                leth_release_res(server, latest);
+
+                // A preview does not reflect the update at full resolution yet
+                if (result != latest || stats.resolutionLevel != 0
+                    || generation <= observedGenerations[spaceIdx])
+                {
+                    std::this_thread::sleep_for(pollInterval);
+                    pollInterval = std::min(2 * pollInterval, maxPollInterval);
+                    continue;
+                }
+                pollInterval = minPollInterval;
+
+                // The first `generation - baseGeneration` updates sent are reflected
+                auto const now { Clock::now() };
+                for (uint64_t i { observedGenerations[spaceIdx] - baseGeneration },
+                     iEnd { std::min<uint64_t>(generation - baseGeneration, events.size()) };
+                     i < iEnd;
+                     ++i)
+                {
+                    latencies[spaceIdx].push_back(
+                        std::chrono::duration<double, std::micro>(now - sendTimes[i]).count());
+                }
+                observedGenerations[spaceIdx] = generation;
+            }
+        });
+    }
+
+    // Updates are applied in the order of the `leth_set` calls, so the n-th call is reflected by
+    // results of generation `baseGeneration + n` and later. The calls of the producers are
+    // serialized to keep that order, which costs little as `leth_set` takes a lock anyway.
+    auto const               start { Clock::now() };
+    std::mutex               sendLock;
+    size_t                   numSent { 0 };
+    std::vector<std::thread> producers;
+    for (uint32_t producerIdx { 0 }; producerIdx < options.numProducers; ++producerIdx)
+    {
+        producers.emplace_back([&, producerIdx] {
+            for (size_t i { producerIdx }; i < events.size(); i += options.numProducers)
+            {
+                auto const& event { events[i] };
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds { event.time });
+
+                std::lock_guard<std::mutex> guard { sendLock };
+                sendTimes[numSent++] = Clock::now();
+                leth_set(server, event.x, event.y, event.temp, event.type);
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+
+    double const elapsed { std::chrono::duration<double>(Clock::now() - start).count() };
+
+    // Waits until every space has published a result reflecting the last update
+    auto const drainDeadline {
+        Clock::now()
+            + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double> { options.drainTimeout }),
+    };
+    uint64_t lastGeneration { leth_get_generation(server) };
+    while (Clock::now() < drainDeadline)
+    {
+        lastGeneration = leth_get_generation(server);
+
+        bool caughtUp { true };
+        for (auto& generation : observedGenerations)
+            caughtUp = caughtUp && generation >= lastGeneration;
+
+        if (caughtUp && lastGeneration - baseGeneration >= events.size())
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+    }
+
+    stopped = true;
+    for (auto& reader : readers) reader.join();
+
+    std::printf("updates: %zu sent, %llu applied in %.3f s (%.1f updates/s, %u producers)\n",
+                events.size(),
+                static_cast<unsigned long long>(lastGeneration - baseGeneration),
+                elapsed,
+                events.size() / elapsed,
+                options.numProducers);
+    std::printf("%-28s %10s %12s %12s %12s %12s\n",
+                "space",
+                "samples",
+                "p50 (us)",
+                "p99 (us)",
+                "p999 (us)",
+                "max (us)");
+    for (SpaceIndex spaceIdx { 0 }; spaceIdx < numSpaces; ++spaceIdx)
+    {
+        auto& samples { latencies[spaceIdx] };
+        std::sort(samples.begin(), samples.end());
+        std::printf("%-28s %10zu %12.1f %12.1f %12.1f %12.1f\n",
+                    leth_get_space_name(server, spaceIdx),
+                    samples.size(),
+                    GetPercentile(samples, 0.5),
+                    GetPercentile(samples, 0.99),
+                    GetPercentile(samples, 0.999),
+                    samples.empty() ? 0.0 : samples.back());
+    }
+
+    leth_delete(server);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Trace.hh"
+
+#include <leth/Journal.hh>
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <map>
+
+namespace
+{
+
+/// Returns the path a journal was started with, i.e. the name of one of its files without the
+/// file index.
+std::string GetJournalPath(std::string const& path)
+{
+    size_t const dot { path.find_last_of('.') };
+    if (dot == std::string::npos || dot + 1 == path.size()
+        || path.find_first_not_of("0123456789", dot + 1) != std::string::npos)
+        return path;
+
+    return path.substr(0, dot);
+}
+
+}
+
+bool LoadTrace(std::vector<std::string> const& paths,
+               uint16_t&                       width,
+               uint16_t&                       height,
+               std::vector<TraceEvent>&        events)
+{
+    // Record times count from the start of their journal, which every file of the journal shares.
+    // The wall-clock start time is only used to line up separate journals, as the one in each
+    // file header is taken again when the file is opened.
+    std::map<std::string, int64_t> journalStartTimes;
+    int64_t                        traceStartTime { std::numeric_limits<int64_t>::max() };
+    size_t const                   firstEvent { events.size() };
+    for (auto& path : paths)
+    {
+        JournalReader reader;
+        if (!reader.Open(path.c_str()))
+        {
+            std::fprintf(stderr, "Cannot open the journal %s\n", path.c_str());
+            return false;
+        }
+
+        width  = reader.width();
+        height = reader.height();
+
+        int64_t const startTime {
+            journalStartTimes.emplace(GetJournalPath(path), reader.startTime()).first->second,
+        };
+        traceStartTime = std::min(traceStartTime, startTime);
+
+        JournalRecord record;
+        while (reader.Next(record))
+        {
+            if (record.type == JournalRecordType::SetPoint)
+            {
+                events.push_back(TraceEvent {
+                    startTime + record.time,
+                    record.x,
+                    record.y,
+                    record.temp,
+                    record.pointType,
+                });
+            }
+        }
+    }
+
+    for (size_t i { firstEvent }; i < events.size(); ++i) events[i].time -= traceStartTime;
+    std::stable_sort(events.begin() + firstEvent,
+                     events.end(),
+                     [](TraceEvent const& lhs, TraceEvent const& rhs) {
+                         return lhs.time < rhs.time;
+                     });
+
+    return true;
+}
@@ -0,0 +1,32 @@
+// Copyright (c) 2021 Chanjung Kim. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef LAPLACE_EQ_THERM_SERVER_CORE_TRACE_HH
+#define LAPLACE_EQ_THERM_SERVER_CORE_TRACE_HH
+
+#include <leth/Point.hh>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Represents a `leth_set` call of a trace.
+struct TraceEvent
+{
+    /// Nanoseconds elapsed since the start of the trace
+    int64_t   time;
+    uint16_t  x, y;
+    float     temp;
+    PointType type;
+};
+
+/// Loads the point updates recorded in the given journal files, ordered by time. The files of a
+/// journal are named `<path>.<index>` and continue the times of each other; separate journals are
+/// lined up by the wall-clock times they were started at. Stores the size of the recorded matrix
+/// into `width` and `height`. Returns `false` if a file cannot be opened.
+bool LoadTrace(std::vector<std::string> const& paths,
+               uint16_t&                       width,
+               uint16_t&                       height,
+               std::vector<TraceEvent>&        events);
+
+#endif
@@ -125,8 +125,14 @@ impl Server {
         let mut ty = Vec::new();
         ty.resize(buff_len, 0);
 
+        // Read first, so the input reflects at least this many updates
+        let generation = unsafe { leth_get_generation(self.handle) };
         self.get_raw(&mut temp, &mut ty);
+        self.to_global_info(&temp, &ty, generation)
+    }
 
+    /// Converts raw temperature information into a `GlobalInfo`.
+    fn to_global_info(&self, temp: &[f32], ty: &[u8], generation: u64) -> GlobalInfo {
         GlobalInfo {
             temp: temp
                 .chunks(self.width as usize)
@@ -144,6 +150,7 @@ impl Server {
                         .collect()
                 })
                 .collect(),
+            generation,
         }
     }
 
@@ -170,8 +177,27 @@ impl Server {
         let mut buff = Vec::new();
         buff.resize(self.width as usize * self.height as usize, 0.0f32);
 
+        let mut generation = 0u64;
+        let error_code = unsafe {
+            leth_get_res_with_generation(
+                self.handle,
+                space_idx,
+                buff.as_mut_ptr(),
+                &mut generation,
+            )
+        };
+        self.to_simulation_result(space_idx, error_code, &buff, generation)
+    }
+
+    /// Converts a raw simulation result into a `SimulationResult`.
+    fn to_simulation_result(
+        &self,
+        space_idx: u32,
+        error_code: u32,
+        buff: &[f32],
+        generation: u64,
+    ) -> SimulationResult {
         let name = self.get_space_name(space_idx);
-        let error_code = self.get_result_raw(space_idx, &mut buff);
         let error_message = self.get_error_message(space_idx, error_code);
         SimulationResult {
             name: String::from(name),
@@ -186,17 +212,47 @@ impl Server {
                         .collect(),
                 )
             },
+            generation,
         }
     }
 
-    /// Returns server state in a form of `SimulationResults`.
+    /// Returns server state in a form of `SimulationResults`. The input and the results of all
+    /// spaces are read in a single call and tagged with the input generation they came from.
     pub fn get_simulation_results(&self) -> SimulationResults {
+        let buff_len = self.width as usize * self.height as usize;
+        let num_spaces = self.get_num_spaces();
+
+        let mut temp = vec![0.0f32; buff_len];
+        let mut ty = vec![0u8; buff_len];
+        let mut results = vec![0.0f32; buff_len * num_spaces as usize];
+        let mut error_codes = vec![0u32; num_spaces as usize];
+        let mut generations = vec![0u64; num_spaces as usize];
+
+        let generation = unsafe {
+            leth_get_snapshot(
+                self.handle,
+                temp.as_mut_ptr(),
+                ty.as_mut_ptr(),
+                results.as_mut_ptr(),
+                error_codes.as_mut_ptr(),
+                generations.as_mut_ptr(),
+            )
+        };
+
         SimulationResults {
             width: self.width,
             height: self.height,
-            info: self.get(),
-            results: (0..self.get_num_spaces())
-                .map(|i| self.get_result(i))
+            info: self.to_global_info(&temp, &ty, generation),
+            results: (0..num_spaces)
+                .zip(results.chunks(buff_len))
+                .map(|(i, buff)| {
+                    self.to_simulation_result(
+                        i,
+                        error_codes[i as usize],
+                        buff,
+                        generations[i as usize],
+                    )
+                })
                 .collect(),
         }
     }
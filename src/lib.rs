@@ -40,6 +40,8 @@ pub struct GlobalInfo {
     pub temp: Vec<Vec<f32>>,
     /// point types
     pub r#type: Vec<Vec<LocalInfoType>>,
+    /// number of point updates applied to the input so far
+    pub generation: u64,
 }
 
 /// Represents a simulation result.
@@ -54,6 +56,8 @@ pub struct SimulationResult {
     pub error_message: String,
     /// temperature information
     pub temp: Option<Vec<Vec<f32>>>,
+    /// generation of the input the result was computed from
+    pub generation: u64,
 }
 
 /// Represents a server state.